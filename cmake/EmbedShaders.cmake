@@ -0,0 +1,28 @@
+# writes a header with the sources of every .vert/.frag pair in SHADER_DIR to OUTPUT
+# usage: cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P EmbedShaders.cmake
+
+file(GLOB VERTEX_SHADERS ${SHADER_DIR}/*.vert)
+list(SORT VERTEX_SHADERS)
+
+set(CONTENT "#pragma once\n\n// generated from src/Shaders by cmake/EmbedShaders.cmake, do not edit\n\n")
+string(APPEND CONTENT "struct EmbeddedShader\n{\n    std::string_view name;\n    std::string_view vertexSource;\n    std::string_view fragmentSource;\n};\n\n")
+string(APPEND CONTENT "inline constexpr std::array s_embeddedShaders = {\n")
+
+foreach(VERTEX_SHADER ${VERTEX_SHADERS})
+    get_filename_component(NAME ${VERTEX_SHADER} NAME_WE)
+    set(FRAGMENT_SHADER ${SHADER_DIR}/${NAME}.frag)
+    if(NOT EXISTS ${FRAGMENT_SHADER})
+        message(FATAL_ERROR "Shader ${NAME} has no fragment shader")
+    endif()
+
+    file(READ ${VERTEX_SHADER} VERTEX_SOURCE)
+    file(READ ${FRAGMENT_SHADER} FRAGMENT_SOURCE)
+    string(APPEND CONTENT "    EmbeddedShader{ \"${NAME}\",\nR\"glsl(${VERTEX_SOURCE})glsl\",\nR\"glsl(${FRAGMENT_SOURCE})glsl\" },\n")
+endforeach()
+
+string(APPEND CONTENT "};\n")
+
+# only touch the header if a shader changed, everything including it would rebuild otherwise
+file(WRITE ${OUTPUT}.tmp "${CONTENT}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -3,6 +3,7 @@
 #include "Application.h"
 
 #include "Scene.h"
+#include "Simulation.h"
 
 #include "Window/Window.h"
 
@@ -25,6 +26,7 @@ Application::Application()
 
     ImGuiLayer::init();
     Scene::init();
+    Simulation::start();
     
     signal(SIGTERM, Application::handleSignal);
     signal(SIGINT, Application::handleSignal);
@@ -32,6 +34,7 @@ Application::Application()
 
 Application::~Application()
 {
+    Simulation::stop();
     ImGuiLayer::shutdown();
     Window::shutdown();
 
@@ -0,0 +1,463 @@
+#include "pch.h"
+
+#include "Benchmarks.h"
+#include "XmlLegacy.h"
+
+#include "Scene.h"
+
+#include "Entities/Mesh.h"
+#include "Entities/Robot.h"
+#include "Entities/TrajectoryFile.h"
+
+#include "ImGui/ImGuiLayer.h"
+
+#include "Xml/XmlParser.h"
+#include "Xml/XmlSaxParser.h"
+
+#include "Util/geometry.h"
+#include "Util/KinematicModel.h"
+#include "Util/Log.h"
+#include "Util/ThreadPool.h"
+#include "Util/TrajectorySampler.h"
+#include "Util/simd.h"
+
+using BenchClock = std::chrono::steady_clock;
+
+static double elapsedMs(const BenchClock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+static std::string syntheticUrdf(const size_t numLinks)
+{
+    std::string urdf = "<robot name=\"synthetic\">\n";
+    for (size_t i = 0; i < numLinks; ++i) {
+        urdf += strPrintf(
+            "  <link name=\"link_%zu\">\n"
+            "    <visual>\n"
+            "      <origin xyz=\"0 0 0.%zu\" rpy=\"0 0 0\"/>\n"
+            "      <geometry><mesh filename=\"link_%zu.stl\"/></geometry>\n"
+            "    </visual>\n"
+            "  </link>\n", i, i, i);
+        if (i > 0)
+            urdf += strPrintf(
+                "  <joint name=\"joint_%zu\" type=\"revolute\">\n"
+                "    <origin xyz=\"0 0 0.1\" rpy=\"0 0 1.5708\"/>\n"
+                "    <parent link=\"link_%zu\"/>\n"
+                "    <child link=\"link_%zu\"/>\n"
+                "    <axis xyz=\"0 0 1\"/>\n"
+                "    <limit lower=\"-2.96\" upper=\"2.96\" effort=\"300.0\" velocity=\"10.0\"/>\n"
+                "  </joint>\n", i, i-1, i);
+    }
+    urdf += "</robot>\n";
+    return urdf;
+}
+
+static size_t countNodes(const LegacyXmlNode& node)
+{
+    size_t count = 1;
+    for (const auto& child : node.children)
+        count += countNodes(child);
+    return count;
+}
+
+void Benchmarks::picking(const size_t numRays)
+{
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    size_t numTriangles = 0;
+    for (const auto&[name, entity] : Scene::getEntities())
+        if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr)
+            for (const auto&[linkName, link] : robot->getLinks()) {
+                if (!link->mesh->hasGeometry())
+                    continue;
+                meshes.push_back(link->mesh);
+                numTriangles += link->mesh->getBvh().numTriangles();
+            }
+
+    if (meshes.empty()) {
+        LOG_WARN << "No meshes to benchmark";
+        return;
+    }
+
+    auto [width, height] = ImGuiLayer::getViewportSize();
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> distX(0.0f, width);
+    std::uniform_real_distribution<float> distY(0.0f, height);
+
+    const auto t_cam_world = CameraController::getCamera().getPosition();
+    std::vector<std::tuple<glm::vec3, glm::vec3>> rays(numRays);
+    for (auto& ray : rays)
+        ray = CameraController::cameraRay({distX(gen), distY(gen)}, t_cam_world);
+
+    const auto castRays = [&](const auto& intersect) {
+        std::vector<float> dists(numRays, std::numeric_limits<float>::max());
+        for (size_t i = 0; i < numRays; ++i)
+            for (const auto& mesh : meshes) {
+                glm::vec3 p_hit_world;
+                float dist;
+                if (intersect(*mesh, rays[i], p_hit_world, dist))
+                    dists[i] = std::min(dists[i], dist);
+            }
+        return dists;
+    };
+
+    auto start = BenchClock::now();
+    const auto distsBrute = castRays([](const Mesh& mesh, const auto& ray, glm::vec3& p_hit_world, float& dist) {
+        return mesh.Entity::rayIntersection(ray, p_hit_world, dist);
+    });
+    const double bruteMs = elapsedMs(start);
+
+    start = BenchClock::now();
+    const auto distsBvh = castRays([](const Mesh& mesh, const auto& ray, glm::vec3& p_hit_world, float& dist) {
+        return mesh.rayIntersection(ray, p_hit_world, dist);
+    });
+    const double bvhMs = elapsedMs(start);
+
+    size_t hits = 0, mismatches = 0;
+    for (size_t i = 0; i < numRays; ++i) {
+        hits += distsBvh[i] != std::numeric_limits<float>::max();
+        if (std::abs(distsBrute[i] - distsBvh[i]) > 1e-3f * std::max(1.0f, distsBvh[i]))
+            mismatches++;
+    }
+
+    LOG_INFO << "Picking: " << numRays << " rays, " << meshes.size() << " meshes, " << numTriangles << " triangles, " << hits << " hits, " << mismatches << " mismatches";
+    LOG_INFO << "Picking: brute force " << bruteMs / numRays << " ms/ray, bvh " << bvhMs / numRays << " ms/ray, speedup " << bruteMs / std::max(bvhMs, 1e-6);
+}
+
+
+void Benchmarks::robotLoad()
+{
+    std::filesystem::path sourceDir;
+    for (const auto&[name, entity] : Scene::getEntities())
+        if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr) {
+            sourceDir = robot->getSourceDir();
+            break;
+        }
+
+    if (sourceDir.empty()) {
+        LOG_WARN << "No robot to benchmark";
+        return;
+    }
+
+    // cold: parse urdf and import every mesh, then write the cache the warm load reads
+    auto start = BenchClock::now();
+    double coldMs;
+    {
+        Robot robot;
+        if (!robot.setup(sourceDir, false, false)) {
+            LOG_WARN << "Robot load failed: " << sourceDir;
+            return;
+        }
+        robot.waitForMeshes();
+        coldMs = elapsedMs(start);
+
+        if (!robot.waitForCache()) {
+            LOG_WARN << "Robot cache could not be written: " << sourceDir;
+            return;
+        }
+    }
+
+    start = BenchClock::now();
+    double warmMs;
+    {
+        Robot robot;
+        if (!robot.setup(sourceDir, true, false)) {
+            LOG_WARN << "Robot load failed: " << sourceDir;
+            return;
+        }
+        robot.waitForMeshes();
+        warmMs = elapsedMs(start);
+    }
+
+    // shared: the robot in the scene already holds the assets, like adding a second instance
+    start = BenchClock::now();
+    double sharedMs;
+    {
+        Robot robot;
+        if (!robot.setup(sourceDir)) {
+            LOG_WARN << "Robot load failed: " << sourceDir;
+            return;
+        }
+        robot.waitForMeshes();
+        sharedMs = elapsedMs(start);
+    }
+
+    LOG_INFO << "Robot load: cold " << coldMs << " ms, warm " << warmMs << " ms, speedup " << coldMs / std::max(warmMs, 1e-6);
+    LOG_INFO << "Robot load: shared " << sharedMs << " ms, speedup " << coldMs / std::max(sharedMs, 1e-6) << ", " << MeshLibrary::numAssets() << " assets in the library";
+}
+
+void Benchmarks::xmlParse(const size_t targetSize)
+{
+    // replicate the loaded urdf into one large document, like a cell with many robots
+    std::string urdf;
+    for (const auto&[name, entity] : Scene::getEntities())
+        if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr && std::filesystem::exists(robot->getSourceDir() / "urdf")) {
+            for (const auto& entry : std::filesystem::directory_iterator(robot->getSourceDir() / "urdf"))
+                if (entry.path().extension() == ".urdf")
+                    urdf = readFile(entry.path());
+            break;
+        }
+    if (urdf.empty())
+        urdf = syntheticUrdf(8);
+
+    std::string doc = "<cell>\n";
+    doc.reserve(targetSize + urdf.size());
+    while (doc.size() < targetSize)
+        doc += urdf;
+    doc += "</cell>\n";
+    const double sizeMb = doc.size() / (1024.0*1024.0);
+
+    auto start = BenchClock::now();
+    size_t numLegacy;
+    {
+        LegacyXmlLexer lexer(doc);
+        LegacyXmlParser parser(lexer.generateTokens());
+        numLegacy = countNodes(parser.parse());
+    }
+    const double legacyMs = elapsedMs(start);
+
+    start = BenchClock::now();
+    size_t numNodes;
+    {
+        XmlParser parser(doc);
+        numNodes = parser.parse().numNodes();
+    }
+    const double parseMs = elapsedMs(start);
+
+    LOG_INFO << "Xml parse: " << sizeMb << " MB, " << numNodes << " nodes (legacy " << numLegacy << ")";
+    LOG_INFO << "Xml parse: legacy " << sizeMb / (legacyMs / 1000.0) << " MB/s, streaming " << sizeMb / (parseMs / 1000.0) << " MB/s, speedup " << legacyMs / std::max(parseMs, 1e-6);
+}
+
+// sums every number it sees, the 4x4 list is parsed on demand like a consumer would
+class AttributeSum : public XmlSaxHandler
+{
+public:
+    virtual void attribute(const std::string_view name, const XmlValue& value) override
+    {
+        if (const auto i = std::get_if<int>(&value); i != nullptr)
+            sum += *i;
+        else if (const auto f = std::get_if<float>(&value); f != nullptr)
+            sum += *f;
+        else if (const auto v = std::get_if<glm::vec3>(&value); v != nullptr)
+            sum += v->x + v->y + v->z;
+        else if (name == "m") {
+            std::array<float, 16> m;
+            if (parseFloats(std::get<std::string_view>(value), m) == m.size())
+                sum += std::accumulate(m.begin(), m.end(), 0.0);
+        }
+        numAttributes++;
+    }
+
+    double sum = 0.0;
+    size_t numAttributes = 0;
+};
+
+static void sumLegacyAttributes(const LegacyXmlNode& node, double& sum, size_t& numAttributes)
+{
+    for (const auto&[name, value] : node.attributes) {
+        if (const auto i = std::get_if<int>(&value); i != nullptr)
+            sum += *i;
+        else if (const auto f = std::get_if<float>(&value); f != nullptr)
+            sum += *f;
+        else if (name == "xyz" || name == "m")
+            for (const auto& part : splitString(std::get<std::string>(value), ",; "))
+                sum += std::stof(part);
+        numAttributes++;
+    }
+
+    for (const auto& child : node.children)
+        sumLegacyAttributes(child, sum, numAttributes);
+}
+
+void Benchmarks::xmlAttributes(const size_t numAttributes)
+{
+    // five attributes per element: int, float, vec3, 4x4 and a name, which the legacy parser only types via an exception
+    std::string doc = "<attributes>\n";
+    for (size_t i = 0; i < numAttributes / 5; ++i)
+        doc += strPrintf(
+            "  <a i=\"%zu\" f=\"0.%zu\" xyz=\"0.1 -0.%zu 3e-2\" m=\"1 0 0 0 0 1 0 0 0 0 1 0 %zu.5 0 0 1\" name=\"link_%zu\"/>\n",
+            i, i, i, i % 100, i);
+    doc += "</attributes>\n";
+
+    auto start = BenchClock::now();
+    double legacySum = 0.0;
+    size_t numLegacy = 0;
+    {
+        LegacyXmlLexer lexer(doc);
+        LegacyXmlParser parser(lexer.generateTokens());
+        sumLegacyAttributes(parser.parse(), legacySum, numLegacy);
+    }
+    const double legacyMs = elapsedMs(start);
+
+    start = BenchClock::now();
+    AttributeSum handler;
+    XmlSaxParser(doc).parse(handler);
+    const double typedMs = elapsedMs(start);
+
+    LOG_INFO << "Xml attributes: " << handler.numAttributes << " attributes (legacy " << numLegacy << "), checksum " << handler.sum << " (legacy " << legacySum << ")";
+    LOG_INFO << "Xml attributes: legacy " << 1e6 * legacyMs / std::max<size_t>(numLegacy, 1) << " ns/attr, typed " << 1e6 * typedMs / std::max<size_t>(handler.numAttributes, 1) << " ns/attr, speedup " << legacyMs / std::max(typedMs, 1e-6);
+}
+
+void Benchmarks::forwardKinematics(const size_t numConfigs)
+{
+    // first loaded robot, otherwise a six axis arm
+    KinematicModel model;
+    std::vector<std::pair<float, float>> limits;
+    for (const auto&[name, entity] : Scene::getEntities())
+        if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr && robot->numJoints() > 0) {
+            model = robot->getKinematics();
+            for (const auto& joint : robot->getJoints())
+                limits.push_back(joint->limits);
+            break;
+        }
+    if (limits.empty()) {
+        std::vector<KinematicJoint> joints;
+        for (uint32_t i = 0; i < 6; ++i) {
+            glm::mat4 t_child_parent = eulerXYZ(glm::vec3(i % 2 ? 1.5708f : 0.0f, 0.0f, 0.0f));
+            setMat4Translation(t_child_parent, glm::vec3(0.0f, 0.0f, 300.0f));
+            joints.emplace_back(i, i + 1, t_child_parent, glm::vec3(0.0f, 0.0f, 1.0f));
+            limits.emplace_back(-3.1416f, 3.1416f);
+        }
+        model.build(joints.size() + 1, joints);
+    }
+
+    const size_t numJoints = limits.size();
+    const size_t numLinks = model.numLinks();
+
+    std::mt19937 rng(42);
+    std::vector<float> jointValues(numJoints*numConfigs);
+    for (size_t j = 0; j < numJoints; ++j) {
+        std::uniform_real_distribution<float> dist(limits[j].first, limits[j].second);
+        for (size_t i = 0; i < numConfigs; ++i)
+            jointValues[j*numConfigs + i] = dist(rng);
+    }
+
+    const glm::mat4 t_base_world(1.0f);
+    std::vector<glm::mat4> scalar(numLinks*numConfigs);
+    std::vector<glm::mat4> batched(numLinks*numConfigs);
+
+    auto start = BenchClock::now();
+    std::vector<float> config(numJoints);
+    for (size_t i = 0; i < numConfigs; ++i) {
+        for (size_t j = 0; j < numJoints; ++j)
+            config[j] = jointValues[j*numConfigs + i];
+        model.evaluate(config, t_base_world, std::span<glm::mat4>(scalar).subspan(i*numLinks, numLinks));
+    }
+    const double scalarMs = elapsedMs(start);
+
+    start = BenchClock::now();
+    model.evaluate(jointValues, numConfigs, t_base_world, batched);
+    const double batchedMs = elapsedMs(start);
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < scalar.size(); ++i)
+        maxError = std::max(maxError, glm::length(glm::vec3(scalar[i][0][3], scalar[i][1][3], scalar[i][2][3]) - glm::vec3(batched[i][0][3], batched[i][1][3], batched[i][2][3])));
+
+    LOG_INFO << "Forward kinematics: " << numConfigs << " configurations, " << numJoints << " joints, " << SimdFloat::s_width << " lanes, max deviation " << maxError << " mm";
+    LOG_INFO << "Forward kinematics: scalar " << numConfigs / (scalarMs / 1000.0) << " configs/s, batched " << numConfigs / (batchedMs / 1000.0) << " configs/s, speedup " << scalarMs / std::max(batchedMs, 1e-6);
+}
+
+void Benchmarks::trajectorySampling(const size_t numSamples, const size_t numJoints)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> jitter(0.0, 0.0002);
+    std::vector<double> times(numSamples);
+    std::vector<float> values(numJoints*numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        times[i] = i*0.001 + jitter(rng);
+        for (size_t j = 0; j < numJoints; ++j)
+            values[j*numSamples + i] = sinf(static_cast<float>(times[i]) * (0.1f + 0.05f*j));
+    }
+
+    auto start = BenchClock::now();
+    TrajectorySampler sampler;
+    sampler.build(times, values, numJoints);
+    const double buildMs = elapsedMs(start);
+
+    // scrubbing, every sample is a jump somewhere into the recording
+    constexpr size_t numScrubs = 100000;
+    std::uniform_real_distribution<double> anywhere(sampler.startTime(), sampler.endTime());
+    std::vector<double> scrubTimes(numScrubs);
+    for (auto& t : scrubTimes)
+        t = anywhere(rng);
+
+    // the previous playback, one index step at a time and a linear map per joint
+    const size_t numWalked = std::min<size_t>(numScrubs, 100);
+    std::vector<float> output(numJoints);
+    size_t index = 1;
+    start = BenchClock::now();
+    for (size_t s = 0; s < numWalked; ++s) {
+        const double t = scrubTimes[s];
+        while (index < numSamples - 1 && t > times[index])
+            index++;
+        while (index > 1 && t < times[index - 1])
+            index--;
+        for (size_t j = 0; j < numJoints; ++j)
+            output[j] = map(static_cast<float>(t), static_cast<float>(times[index - 1]), static_cast<float>(times[index]), values[j*numSamples + index - 1], values[j*numSamples + index]);
+    }
+    const double walkMs = elapsedMs(start);
+
+    TrajectorySampler::Cursor cursor;
+    start = BenchClock::now();
+    for (const double t : scrubTimes)
+        sampler.sample(t, cursor, output);
+    const double scrubMs = elapsedMs(start);
+
+    // playback at the simulation rate
+    cursor = {};
+    start = BenchClock::now();
+    for (size_t i = 0; i < numSamples; ++i)
+        sampler.sample(i*0.001, cursor, output);
+    const double playMs = elapsedMs(start);
+
+    LOG_INFO << "Trajectory sampling: " << numSamples << " samples, " << numJoints << " joints, built in " << buildMs << " ms";
+    LOG_INFO << "Trajectory sampling: scrub walk " << walkMs*1000.0 / numWalked << " us/sample, gallop " << scrubMs*1000.0 / numScrubs << " us/sample";
+    LOG_INFO << "Trajectory sampling: playback " << numSamples / (playMs / 1000.0) << " samples/s";
+}
+
+void Benchmarks::trajectoryParse(const size_t numSamples, const size_t numJoints)
+{
+    const auto file = std::filesystem::temp_directory_path() / "robovis_trajectory_benchmark.txt";
+    {
+        std::ofstream out(file);
+        std::array<char, 512> line;
+        for (size_t i = 0; i < numSamples; ++i) {
+            char* p = line.data();
+            for (size_t j = 0; j < numJoints; ++j) {
+                p = std::to_chars(p, line.data() + line.size(), sinf(i*0.001f*(0.1f + 0.05f*j)), std::chars_format::fixed, 6).ptr;
+                *p++ = ';';
+            }
+            p = std::to_chars(p, line.data() + line.size(), i*0.001, std::chars_format::fixed, 3).ptr;
+            *p++ = '\n';
+            out.write(line.data(), p - line.data());
+        }
+    }
+    const double mib = std::filesystem::file_size(file) / (1024.0*1024.0);
+
+    // the previous loader, one vector of strings per line
+    auto start = BenchClock::now();
+    {
+        std::ifstream in(file);
+        std::vector<std::vector<float>> jointValues;
+        std::vector<float> times;
+        std::string line;
+        while (std::getline(in, line)) {
+            const auto parts = splitString(line, ";, ");
+            std::vector<float> values(numJoints);
+            for (size_t j = 0; j < numJoints; ++j)
+                values[j] = std::stof(parts[j]);
+            jointValues.push_back(values);
+            times.push_back(std::stof(parts[numJoints]));
+        }
+    }
+    const double legacyMs = elapsedMs(start);
+
+    start = BenchClock::now();
+    const auto sampler = TrajectoryFile::readText(file, numJoints);
+    const double chunkedMs = elapsedMs(start);
+
+    std::filesystem::remove(file);
+
+    LOG_INFO << "Trajectory parse: " << numSamples << " lines, " << mib << " MiB, " << ThreadPool::get().size() << " threads, " << (sampler ? sampler->numSamples() : 0) << " samples";
+    LOG_INFO << "Trajectory parse: line by line " << mib / (legacyMs / 1000.0) << " MiB/s, chunked " << mib / (chunkedMs / 1000.0) << " MiB/s, speedup " << legacyMs / std::max(chunkedMs, 1e-6);
+}
\ No newline at end of file
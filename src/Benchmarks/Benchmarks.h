@@ -0,0 +1,16 @@
+#pragma once
+
+class Benchmarks
+{
+public:
+    static void picking(const size_t numRays = 2000);
+    static void robotLoad();
+    static void xmlParse(const size_t targetSize = 16*1024*1024);
+    static void xmlAttributes(const size_t numAttributes = 100000);
+    static void forwardKinematics(const size_t numConfigs = 100000);
+
+    // one hour at 1 kHz
+    static void trajectorySampling(const size_t numSamples = 3600000, const size_t numJoints = 7);
+    static void trajectoryParse(const size_t numSamples = 3600000, const size_t numJoints = 7);
+
+};
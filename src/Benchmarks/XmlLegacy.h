@@ -0,0 +1,352 @@
+#pragma once
+
+// copy of the original token vector based xml lexer/parser, only kept as a baseline for Benchmarks::xmlParse
+
+enum class LegacyXmlTokenType
+{
+    COMMENT,
+    INSTRUCTION,
+    NODE_START,
+    NODE_END,
+    NODE_FULL,
+    CONTENT
+};
+
+struct LegacyXmlToken
+{
+    LegacyXmlTokenType type;
+    std::string tag;
+    std::string data;
+};
+
+class LegacyXmlLexer
+{
+public:
+    LegacyXmlLexer(const std::string& raw) : m_raw(raw), m_i(0) {}
+
+    std::vector<LegacyXmlToken> generateTokens()
+    {
+        m_tokens.clear();
+        m_i = 0;
+
+        bool isContent = false;
+        size_t contentStart = 0;
+        size_t contentEnd = 0;
+        while(m_i < m_raw.size()) {
+
+            if (m_raw[m_i] == '<') {                
+                // content end
+                if (isContent) {
+                    isContent = false;
+
+                    contentEnd = m_i;
+
+                    m_tokens.emplace_back(
+                        LegacyXmlTokenType::CONTENT,
+                        "",
+                        m_raw.substr(contentStart, contentEnd-contentStart)
+                    );
+                    
+                    auto& content = m_tokens.back().data;
+                    content.erase(std::remove(content.begin(), content.end(), '\n'), content.end());
+                    content.erase(std::remove(content.begin(), content.end(), '\r'), content.end());
+                }
+
+                m_i++;
+
+                // comment
+                if (m_raw[m_i] == '!' && m_raw[m_i+1] == '-' && m_raw[m_i+2] == '-') {
+                    m_i += 3;
+                    generateCommentXmlToken();
+                }
+                // instruction
+                if (m_raw[m_i] == '?') {
+                    m_i++;
+                    generateInstructionXmlToken();
+                }
+                // end of node
+                else if (m_raw[m_i] == '/') {
+                    m_i++;
+                    generateNodeEndXmlToken();
+                }
+                // start of node
+                else {
+                    generateNodeStartXmlToken();
+                }
+
+            }
+            else {
+                              
+                // content start
+                if (!isContent && m_raw[m_i] != '<') {                    
+                    if (m_raw[m_i] != ' ' && m_raw[m_i] != '\n' && m_raw[m_i] != '\r' && m_raw[m_i] != '\t') {
+                        isContent = true;
+                        contentStart = m_i;
+                    }
+                }
+              
+                m_i++;
+
+            }
+        }
+
+        return m_tokens;
+    }
+
+private:
+    void generateCommentXmlToken()
+    {
+        const size_t start = m_i;
+        while((m_raw[m_i] != '-' || m_raw[m_i+1] != '-' || m_raw[m_i+2] != '>') && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        const size_t end = m_i;
+        m_i += 3;
+
+        m_tokens.emplace_back(
+            LegacyXmlTokenType::COMMENT,
+            "",
+            m_raw.substr(start, end-start)
+        );
+    }
+
+    void generateInstructionXmlToken()
+    {
+        // tag (target)
+        const size_t tagStart = m_i;
+        while((m_raw[m_i] != '?' || m_raw[m_i+1] != '>') && m_raw[m_i] != ' ' && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        const size_t tagEnd = m_i;
+        
+        m_tokens.emplace_back(
+            LegacyXmlTokenType::INSTRUCTION,
+            m_raw.substr(tagStart, tagEnd-tagStart),
+            ""
+        );
+    
+        // no content
+        if (m_raw[m_i] != ' ') {
+            m_i += 2;
+            return;
+        }
+        m_i++;
+
+        // content
+        const size_t contentStart = m_i;              
+        while((m_raw[m_i] != '?' || m_raw[m_i+1] != '>') && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        const size_t contentEnd = m_i;
+        m_i += 2;
+
+        m_tokens.back().data = m_raw.substr(contentStart, contentEnd-contentStart);
+    }
+
+    void generateNodeStartXmlToken()
+    {
+        // tag
+        const size_t tagStart = m_i;
+        while(m_raw[m_i] != '>' &&  m_raw[m_i] != ' ' && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        size_t tagEnd = m_i;
+        m_i++;
+
+        m_tokens.emplace_back(
+            LegacyXmlTokenType::NODE_START,
+            m_raw.substr(tagStart, tagEnd-tagStart),
+            ""
+        );
+
+        if (m_raw[m_i-2] == '/') {
+            m_tokens.back().type = LegacyXmlTokenType::NODE_FULL;
+            tagEnd--;
+            m_tokens.back().tag = m_raw.substr(tagStart, tagEnd-tagStart);
+        }
+
+        // no content
+        if (m_raw[m_i-1] != ' ') {
+            if (m_raw[m_i-2] == '/')
+                m_tokens.back().type = LegacyXmlTokenType::NODE_FULL;
+            return;
+        }
+
+        // content
+        const size_t contentStart = m_i;              
+        while(m_raw[m_i] != '>' && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        size_t contentEnd = m_i;
+        m_i++;
+
+        if (m_raw[m_i-2] == '/') {
+            m_tokens.back().type = LegacyXmlTokenType::NODE_FULL;
+            contentEnd--;
+        }
+        m_tokens.back().data = m_raw.substr(contentStart, contentEnd-contentStart);
+    }
+
+    void generateNodeEndXmlToken()
+    {
+        const size_t start = m_i;
+        while(m_raw[m_i] != '>' && m_i < m_raw.size()) { 
+            m_i++; 
+        }
+        const size_t end = m_i;
+        m_i++;
+
+        m_tokens.emplace_back(
+            LegacyXmlTokenType::NODE_END,
+            m_raw.substr(start, end-start),
+            ""
+        );
+    }
+
+    std::string m_raw;
+    size_t m_i;
+    std::vector<LegacyXmlToken> m_tokens;
+
+};
+
+struct LegacyXmlNode
+{
+    LegacyXmlNode* parent;
+    std::vector<LegacyXmlNode> children;
+    std::string tag;
+    std::string content;
+    std::map<std::string, std::variant<int, float, std::string>> attributes;
+};
+
+class LegacyXmlParser
+{
+public:
+    LegacyXmlParser(const std::vector<LegacyXmlToken>& tokens) : m_tokens(tokens), m_i(0) {}
+
+    LegacyXmlNode parse()
+    {
+        m_root = LegacyXmlNode{
+            .parent = nullptr,
+            .children = {},
+            .tag = "",
+            .content = "",
+            .attributes = {}
+        };
+        m_i = 0;
+
+        if (m_tokens.empty())
+            return m_root;
+
+        createNodes(&m_root);
+        return m_root;
+    }
+
+private:
+    void createNodes(LegacyXmlNode* parent)
+    {
+        while(m_i < m_tokens.size()) {
+            auto token = m_tokens[m_i++];
+            
+            // add content
+            if (token.type == LegacyXmlTokenType::CONTENT) {
+                parent->content = token.data;
+            }
+            // add full node
+            else if (token.type == LegacyXmlTokenType::NODE_FULL) {
+                parent->children.push_back(LegacyXmlNode{
+                    .parent = parent,
+                    .children = {},
+                    .tag = token.tag,
+                    .content = "",
+                    .attributes = {}
+                });
+                parseAttributes(parent->children.back(), token);
+            }
+            // start new node
+            else if (token.type == LegacyXmlTokenType::NODE_START) {
+                parent->children.push_back(LegacyXmlNode{
+                    .parent = parent,
+                    .children = {},
+                    .tag = token.tag,
+                    .content = "",
+                    .attributes = {}
+                });
+                parseAttributes(parent->children.back(), token);
+                createNodes(&parent->children.back());
+            }
+            // node end
+            else if (token.type == LegacyXmlTokenType::NODE_END) {
+                return;
+            }
+        }
+    }
+
+    void parseAttributes(LegacyXmlNode& node, const LegacyXmlToken& token)
+    {
+        const std::string attr = token.data;
+
+        bool isDigit = false;
+        bool isInt = false;
+        bool isVal = false;
+        bool valFirst = false;
+        bool quotExpectet = false;
+        std::string name, val;
+        for (const char c : attr) {
+            if (!isVal && c == ' ')
+                continue;
+
+            if (isVal) {
+                if (valFirst && c != ' ') {
+                    valFirst = false;
+                    quotExpectet = c == '"';
+                } 
+                else if (!valFirst) {
+                    if ((quotExpectet && c == '"') || (!quotExpectet && c == ' ')) {
+                        quotExpectet = false;
+                        isVal = false;
+                        if (!val.empty() && !name.empty()) {
+                            if (isDigit)
+                                try {
+                                    if (isInt)
+                                        node.attributes.emplace(name, std::stoi(val));
+                                    else 
+                                        node.attributes.emplace(name, std::stof(val));
+                                }
+                                catch(std::exception& e) {
+                                    node.attributes.emplace(name, val);
+                                }
+                            else
+                                node.attributes.emplace(name, val);
+                        }
+                        name = "";
+                    }
+                    else {
+                        if (c == ' ' || c == ',')
+                            isDigit = false;
+
+                        if (c == '.')
+                            isInt = false;
+
+                        val += c;
+                    }
+                }
+            } else {
+                if (c == '=') {
+                    isVal = true;
+                    valFirst = true;
+                    isInt = true;
+                    isDigit = true;
+                    val = "";
+                } 
+                else {
+                    name += c;
+                }
+            }
+        }
+    }
+
+    std::vector<LegacyXmlToken> m_tokens;
+    size_t m_i;
+    LegacyXmlNode m_root;
+
+};
\ No newline at end of file
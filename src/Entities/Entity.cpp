@@ -5,8 +5,11 @@
 #include "Util/Log.h"
 #include "Util/geometry.h"
 
+std::atomic<uint64_t> Entity::s_numTriUpdates = 0;
+std::atomic<uint64_t> Entity::s_numTriUpdatesAvoided = 0;
+
 Entity::Entity()
-    : m_shader(nullptr), m_model(1.0f), m_visible(true)
+    : m_shader(nullptr), m_model(1.0f), m_visible(true), m_triDirty(true), m_bbDirty(true)
 {
 }
 
@@ -18,13 +21,14 @@ Entity::~Entity()
 bool Entity::rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const
 {
     const auto& [v_ray_world, p_ray_world] = ray_world;
+    const auto triData = getTriangulationData();
 
     minDist = std::numeric_limits<float>::max();
     bool hit = false;
-    for (const auto& indices : m_triData->indices) {
+    for (const auto& indices : triData->indices) {
         std::array<glm::vec3, 3> p_vertices_world;
         for (size_t i = 0; i < 3; ++i)
-            p_vertices_world[i] = m_triData->vertices[indices[i]];
+            p_vertices_world[i] = triData->vertices[indices[i]];
 
         const auto[n_tri_world, p_tri_world] = trianglePlane(p_vertices_world);
         glm::vec3 p_hitTmp_world;                               
@@ -42,35 +46,63 @@ bool Entity::rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world,
     return hit;
 }
 
+std::shared_ptr<TriangulationData> Entity::getTriangulationData() const
+{
+    // world-space data is only derived when someone actually asks for it
+    if (m_triDirty && m_triData) {
+        const_cast<Entity*>(this)->updateTriangulationData();
+        s_numTriUpdates++;
+    }
+    m_triDirty = false;
+
+    return m_triData;
+}
+
+const BoundingBox& Entity::getBoundingBox() const
+{
+    if (m_bbDirty) {
+        m_worldBB = m_localBB.transformed(m_model);
+        m_bbDirty = false;
+    }
+
+    return m_worldBB;
+}
+
+TriangulationStats Entity::getTriangulationStats()
+{
+    return { s_numTriUpdates, s_numTriUpdatesAvoided };
+}
+
 void Entity::reset()
 {
     m_model = glm::mat4(1.0f);
+    invalidateTriangulationData();
 }
 
 void Entity::setTranslation(const glm::vec3& p_world)
 {
     setMat4Translation(m_model, p_world);
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity::setRotation(const float angle, const glm::vec3& v_axis_world)
 {
     const glm::mat3 r_world = angleAxisF(angle, v_axis_world);
     setMat4Rotation(m_model, r_world);
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity::setTransformation(const glm::mat4& t_ent_world)
 {
     m_model = t_ent_world;
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity::translateWorld(const glm::vec3& v_world)
 {
     for (size_t i = 0; i < 3; ++i)
         m_model[i][3] += v_world[i];
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity:: translate(const glm::vec3& v_ent)
@@ -83,31 +115,33 @@ void Entity::rotate(const float angle, const glm::vec3& v_axis_ent)
 {
     const auto r_ent = angleAxisF(angle, v_axis_ent);
     m_model = glm::mat4(r_ent) * m_model;
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity::rotate(const glm::mat3& r_ent)
 {
     m_model = glm::mat4(r_ent) * m_model;
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
 void Entity::transform(const glm::mat4& t_ent)
 {
     m_model = t_ent * m_model;
-    updateTriangulationData();
+    invalidateTriangulationData();
 } 
 
 void Entity::scale(const glm::vec3& scale)
 {
     m_model = glm::transpose(glm::scale(glm::transpose(m_model), scale));
-    updateTriangulationData();
+    invalidateTriangulationData();
 }
 
-void Entity::updateMvp(const Camera& camera)
+void Entity::invalidateTriangulationData()
 {
-    glm::mat4 mvp = camera.getProjection() * camera.getView() * glm::transpose(m_model);
+    // an eager implementation would have recomputed everything for the previous change
+    if (m_triDirty && m_triData)
+        s_numTriUpdatesAvoided++;
 
-    m_shader->bind();
-    m_shader->uploadMat4("u_mvp", mvp);
+    m_triDirty = true;
+    m_bbDirty = true;
 }
\ No newline at end of file
@@ -6,7 +6,102 @@
 struct TriangulationData
 {
     std::vector<glm::vec3> vertices;
-    std::vector<std::array<uint16_t, 3>> indices;
+    std::vector<std::array<uint32_t, 3>> indices;
+};
+
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    inline bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    inline void grow(const glm::vec3& p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    inline void grow(const BoundingBox& bb)
+    {
+        min = glm::min(min, bb.min);
+        max = glm::max(max, bb.max);
+    }
+
+    BoundingBox transformed(const glm::mat4& t) const
+    {
+        BoundingBox bb;
+        if (!isValid())
+            return bb;
+
+        for (size_t i = 0; i < 8; ++i) {
+            const glm::vec3 p_corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+            bb.grow(glm::vec3(glm::vec4(p_corner, 1.0f) * t));
+        }
+        return bb;
+    }
+};
+
+// planes of a view frustum, normals point inwards
+struct Frustum
+{
+    std::array<glm::vec4, 6> planes;
+
+    Frustum() = default;
+
+    // gribb/hartmann, the planes are rows of the view projection combined with its w row
+    Frustum(const glm::mat4& viewProjection)
+    {
+        const glm::mat4 m = glm::transpose(viewProjection);
+        for (size_t i = 0; i < 3; ++i) {
+            planes[2*i] = m[3] + m[i];
+            planes[2*i + 1] = m[3] - m[i];
+        }
+        for (auto& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // planes in the space t maps from, same convention as BoundingBox::transformed
+    Frustum transformed(const glm::mat4& t) const
+    {
+        Frustum frustum;
+        for (size_t i = 0; i < planes.size(); ++i)
+            frustum.planes[i] = t * planes[i];
+        return frustum;
+    }
+
+    // conservative, boxes near a corner may pass, invalid boxes always do
+    bool intersects(const BoundingBox& bb) const
+    {
+        if (!bb.isValid())
+            return true;
+
+        for (const auto& plane : planes) {
+            const glm::vec3 p_positive(plane.x >= 0.0f ? bb.max.x : bb.min.x, plane.y >= 0.0f ? bb.max.y : bb.min.y, plane.z >= 0.0f ? bb.max.z : bb.min.z);
+            if (glm::dot(glm::vec3(plane), p_positive) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool contains(const BoundingBox& bb) const
+    {
+        if (!bb.isValid())
+            return false;
+
+        for (const auto& plane : planes) {
+            const glm::vec3 p_negative(plane.x >= 0.0f ? bb.min.x : bb.max.x, plane.y >= 0.0f ? bb.min.y : bb.max.y, plane.z >= 0.0f ? bb.min.z : bb.max.z);
+            if (glm::dot(glm::vec3(plane), p_negative) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+struct TriangulationStats
+{
+    uint64_t updates;
+    uint64_t updatesAvoided;
 };
 
 class Entity {
@@ -16,7 +111,6 @@ public:
     virtual ~Entity();
 
     virtual void draw(const Camera& camera) = 0;
-    virtual void updateTriangulationData() = 0;
 
     virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const;
 
@@ -35,17 +129,31 @@ public:
     inline glm::mat4 getModel() const { return m_model; }
     inline glm::mat4 getPos() const { return getModel(); }
 
-    inline std::shared_ptr<TriangulationData> getTriangulationData() const { return m_triData; }
+    std::shared_ptr<TriangulationData> getTriangulationData() const;
+    virtual const BoundingBox& getBoundingBox() const;
+    inline const BoundingBox& getLocalBoundingBox() const { return m_localBB; }
+
+    static TriangulationStats getTriangulationStats();
 
     inline bool isVisible() const { return m_visible; }
     inline void setVisible(const bool visible) { m_visible = visible; }
 
 protected:    
-    void updateMvp(const Camera& camera);
+    virtual void updateTriangulationData() = 0;
+    void invalidateTriangulationData();
 
     glm::mat4 m_model;
     std::shared_ptr<Shader> m_shader;
     std::shared_ptr<TriangulationData> m_triData;
+    BoundingBox m_localBB;
     bool m_visible;
 
+private:
+    mutable bool m_triDirty;
+    mutable bool m_bbDirty;
+    mutable BoundingBox m_worldBB;
+
+    static std::atomic<uint64_t> s_numTriUpdates;
+    static std::atomic<uint64_t> s_numTriUpdatesAvoided;
+
 };
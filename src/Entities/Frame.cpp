@@ -4,32 +4,32 @@
 
 #include "Renderer/Renderer.h"
 
+std::weak_ptr<VertexArray> Frame::s_vertexArray;
+
 Frame::Frame()
 {
-    if (ShaderLibrary::exists("Color"))
-        m_shader = ShaderLibrary::get("Color");
-    else
-        m_shader = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/Color", "Color");
+    m_shader = ShaderLibrary::get("Color");
 
-    createBuffers();
-}
+    m_localBB = { glm::vec3(-0.025f), glm::vec3(1.0f) };
 
-Frame::~Frame()
-{
-    m_vertexArray.release();
+    m_vertexArray = s_vertexArray.lock();
+    if (!m_vertexArray) {
+        m_vertexArray = createBuffers();
+        s_vertexArray = m_vertexArray;
+    }
 }
 
-void Frame::draw(const Camera& camera)
+Frame::~Frame() = default;
+
+void Frame::draw(const Camera& /*camera*/)
 {
     if (!m_visible)
         return;
 
-    updateMvp(camera);
-        
-    Renderer::draw(m_shader, m_vertexArray);
+    Renderer::submit(m_shader, *m_vertexArray, glm::transpose(m_model));
 }
 
-void Frame::createBuffers()
+std::shared_ptr<VertexArray> Frame::createBuffers()
 {
     constexpr std::array<GLfloat, 8 * 3 * 7> vertices = {
         -0.025f, -0.025f,  0.025f,      1.0f, 0.0f, 0.0f, 1.0f,
@@ -108,9 +108,12 @@ void Frame::createBuffers()
         { ShaderDataType::Float4, "a_color" }
     };
     vertexBuffer->setLayout(layout);
-    m_vertexArray.addVertexBuffer(vertexBuffer);
+
+    std::shared_ptr<VertexArray> vertexArray = std::make_shared<VertexArray>();
+    vertexArray->addVertexBuffer(vertexBuffer);
 
     std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
     indexBuffer->allocate(indices.data(), indices.size());
-    m_vertexArray.setIndexBuffer(indexBuffer);
+    vertexArray->setIndexBuffer(indexBuffer);
+    return vertexArray;
 }
\ No newline at end of file
@@ -11,12 +11,17 @@ public:
     virtual ~Frame();
 
     virtual void draw(const Camera& camera) override;
-    virtual void updateTriangulationData() override { }
 
     inline virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const override { return false; }
 
+protected:
+    virtual void updateTriangulationData() override { }
+
 private:
-    void createBuffers();
+    static std::shared_ptr<VertexArray> createBuffers();
+
+    // all frames draw the same gizmo, they share one vertex array and go out as a single instanced draw
+    std::shared_ptr<VertexArray> m_vertexArray;
 
-    VertexArray m_vertexArray;
+    static std::weak_ptr<VertexArray> s_vertexArray;
 };
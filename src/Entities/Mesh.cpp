@@ -2,132 +2,496 @@
 
 #include "Mesh.h"
 
+#include "Scene.h"
+
 #include "Renderer/Renderer.h"
 
 #include "ImGui/ImGuiLayer.h"
 
 #include "Util/geometry.h"
+#include "Util/MappedFile.h"
+#include "Util/ThreadPool.h"
+
+glm::vec3 MeshData::position(const size_t i) const
+{
+    const auto& pos = vertices[i].pos;
+    return bb.min + glm::vec3(pos[0], pos[1], pos[2]) / 65535.0f * (bb.max - bb.min);
+}
+
+MeshAsset::MeshAsset(std::future<std::shared_ptr<MeshGeometry>>&& import, const std::filesystem::path& file, const uint64_t hash)
+    : m_import(std::move(import)), m_numUploaded(0), m_file(file), m_hash(hash)
+{
+}
+
+MeshAsset::MeshAsset(const std::shared_ptr<const MeshGeometry>& geometry, const std::filesystem::path& file, const uint64_t hash)
+    : m_numUploaded(0), m_file(file), m_hash(hash)
+{
+    setGeometry(geometry);
+}
+
+bool MeshAsset::poll()
+{
+    if (!m_import.valid())
+        return true;
+    if (m_import.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    if (const auto result = m_import.get(); result)
+        setGeometry(result);
+    return true;
+}
+
+void MeshAsset::wait()
+{
+    if (m_import.valid())
+        m_import.wait();
+}
+
+bool MeshAsset::upload(const bool limited)
+{
+    if (!m_geometry)
+        return false;
+
+    while (m_numUploaded < m_geometry->meshData.size()) {
+        const auto& meshData = m_geometry->meshData[m_numUploaded];
+        size_t bytes = meshData.vertices.size()*sizeof(MeshData::Vertex) + meshData.indices.size()*sizeof(meshData.indices[0]);
+        for (const auto& lod : meshData.lods)
+            bytes += lod.indices.size()*sizeof(lod.indices[0]);
+        if (limited && !Renderer::acquireUploadBudget(bytes))
+            return false;
+
+        createBuffers(m_numUploaded++);
+    }
+
+    return true;
+}
+
+void MeshAsset::setGeometry(const std::shared_ptr<const MeshGeometry>& geometry)
+{
+    m_geometry = geometry;
+
+    size_t numLevels = 1;
+    for (const auto& meshData : m_geometry->meshData)
+        numLevels = std::max(numLevels, meshData.lods.size() + 1);
+
+    m_lodErrors.assign(numLevels, 0.0f);
+    for (const auto& meshData : m_geometry->meshData)
+        for (size_t level = 1; level < numLevels && !meshData.lods.empty(); ++level)
+            m_lodErrors[level] = std::max(m_lodErrors[level], meshData.lods[std::min(level, meshData.lods.size()) - 1].error);
+
+    m_vertexArrays = std::vector<std::vector<VertexArray>>(m_geometry->meshData.size());
+    m_numUploaded = 0;
+
+    // a few bytes, not worth a share of the upload budget
+    createBoundingBoxBuffers();
+}
+
+void MeshAsset::createBuffers(const size_t i)
+{
+    const auto& meshData = m_geometry->meshData[i];
+    const auto& vertices = meshData.vertices;
+    auto& vertexArrays = m_vertexArrays[i];
+
+    std::shared_ptr<VertexBuffer> vertexBuffer = std::make_shared<VertexBuffer>();
+    vertexBuffer->allocate(reinterpret_cast<const GLfloat*>(vertices.data()), vertices.size() * sizeof(MeshData::Vertex)/sizeof(float));
+    BufferLayout layout = {
+        { ShaderDataType::UShort3, "a_position", true },
+        { ShaderDataType::Byte2, "a_normal", true }
+    };
+    vertexBuffer->setLayout(layout);
+
+    // 16 bit indices whenever the sub-mesh allows it, halves the index bandwidth
+    const auto createIndexBuffer = [&vertices](const std::span<const std::array<uint32_t, 3>> indices) {
+        std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
+        if (vertices.size() <= std::numeric_limits<GLushort>::max() + size_t(1)) {
+            std::vector<GLushort> narrowed(3*indices.size());
+            for (size_t j = 0; j < narrowed.size(); ++j)
+                narrowed[j] = static_cast<GLushort>(indices[j/3][j%3]);
+            indexBuffer->allocate(narrowed.data(), narrowed.size());
+        }
+        else
+            indexBuffer->allocate(indices.data()->data(), 3*indices.size());
+        return indexBuffer;
+    };
+
+    // all levels share the vertex buffer
+    vertexArrays = std::vector<VertexArray>(meshData.lods.size() + 1);
+    for (size_t level = 0; level < vertexArrays.size(); ++level) {
+        vertexArrays[level].addVertexBuffer(vertexBuffer);
+        vertexArrays[level].setIndexBuffer(createIndexBuffer(level == 0 ? meshData.indices : meshData.lods[level - 1].indices));
+    }
+}
+
+void MeshAsset::createBoundingBoxBuffers()
+{
+    const auto& [p_min, p_max] = m_geometry->bb;
+    m_bbData.vertices[0] = glm::vec3{p_min.x, p_min.y, p_min.z};
+    m_bbData.vertices[1] = glm::vec3{p_max.x, p_min.y, p_min.z};
+    m_bbData.vertices[2] = glm::vec3{p_max.x, p_max.y, p_min.z};
+    m_bbData.vertices[3] = glm::vec3{p_min.x, p_max.y, p_min.z};
+    m_bbData.vertices[4] = glm::vec3{p_min.x, p_min.y, p_max.z};
+    m_bbData.vertices[5] = glm::vec3{p_max.x, p_min.y, p_max.z};
+    m_bbData.vertices[6] = glm::vec3{p_max.x, p_max.y, p_max.z};
+    m_bbData.vertices[7] = glm::vec3{p_min.x, p_max.y, p_max.z};
+
+    std::shared_ptr<VertexBuffer> vertexBuffer = std::make_shared<VertexBuffer>();
+    vertexBuffer->allocate(reinterpret_cast<const GLfloat*>(m_bbData.vertices.data()), m_bbData.vertices.size() * 3);
+    BufferLayout layout = {
+        { ShaderDataType::Float3, "a_position" }
+    };
+    vertexBuffer->setLayout(layout);
+    m_vertexArrayBB.addVertexBuffer(vertexBuffer);
+
+    std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
+    indexBuffer->allocate(reinterpret_cast<const GLushort*>(m_bbData.indices.data()), 3*m_bbData.indices.size());
+    m_vertexArrayBB.setIndexBuffer(indexBuffer);
+}
+
+// ------------------------------------------------------
+
+std::unordered_map<uint64_t, std::weak_ptr<MeshAsset>> MeshLibrary::s_assets;
+
+std::shared_ptr<MeshAsset> MeshLibrary::load(const std::filesystem::path& file, const uint64_t hash, const bool shared)
+{
+    if (shared)
+        if (auto asset = get(hash); asset)
+            return asset;
+
+    auto asset = std::make_shared<MeshAsset>(ThreadPool::get().submit([file]() {
+        return Mesh::import(file);
+    }), file, hash);
+
+    if (shared)
+        s_assets[hash] = asset;
+    return asset;
+}
+
+std::shared_ptr<MeshAsset> MeshLibrary::add(const std::filesystem::path& file, const uint64_t hash, const std::shared_ptr<const MeshGeometry>& geometry)
+{
+    if (auto asset = get(hash); asset)
+        return asset;
+
+    auto asset = std::make_shared<MeshAsset>(geometry, file, hash);
+    s_assets[hash] = asset;
+    return asset;
+}
+
+std::shared_ptr<MeshAsset> MeshLibrary::get(const uint64_t hash)
+{
+    std::erase_if(s_assets, [](const auto& entry) { return entry.second.expired(); });
+
+    const auto it = s_assets.find(hash);
+    return it != s_assets.end() ? it->second.lock() : nullptr;
+}
+
+uint64_t MeshLibrary::computeHash(const std::filesystem::path& file)
+{
+    // the extension decides the importer, same bytes under another format are another asset
+    const std::string extension = file.extension().string();
+    uint64_t hash = hashBytes(extension.data(), extension.size());
+
+    const MappedFile mapped(file);
+    if (mapped.isOpen())
+        hash = hashBytes(mapped.data(), mapped.size(), hash);
+    return hash;
+}
+
+size_t MeshLibrary::numAssets()
+{
+    std::erase_if(s_assets, [](const auto& entry) { return entry.second.expired(); });
+    return s_assets.size();
+}
+
+// ------------------------------------------------------
+
+Mesh::Mesh()
+    : m_lod(0)
+{
+    m_shader = ShaderLibrary::get("Mesh");
+
+    m_shaderBB = ShaderLibrary::get("FlatColor");
+}
 
 Mesh::Mesh(const aiScene* source, const glm::mat4& t_mesh_world)
+    : Mesh()
 {
-    if (ShaderLibrary::exists("Color"))
-        m_shader = ShaderLibrary::get("Color");
-    else
-        m_shader = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/Color", "Color");
+    setGeometry(std::make_shared<MeshGeometry>(createGeometry(source, t_mesh_world)));
+    upload(false);
+}
 
-    if (ShaderLibrary::exists("FlatColor"))
-        m_shaderBB = ShaderLibrary::get("FlatColor");
-    else
-        m_shaderBB = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/FlatColor", "FlatColor");
+Mesh::~Mesh() = default;
+
+std::shared_ptr<MeshGeometry> Mesh::import(const std::filesystem::path& file, const glm::mat4& t_mesh_world, const bool meshlets)
+{
+    Assimp::Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_IMPORT_COLLADA_IGNORE_UP_DIRECTION, 1);
+    const aiScene* source = importer.ReadFile(file.c_str(), aiProcessPreset_TargetRealtime_Fast);
+    if (source == nullptr) {
+        LOG_ERROR << "Failed to import mesh-file: " << file << " (" << importer.GetErrorString() << ")";
+        return nullptr;
+    }
+
+    return std::make_shared<MeshGeometry>(createGeometry(source, t_mesh_world, meshlets));
+}
+
+MeshGeometry Mesh::createGeometry(const aiScene* source, const glm::mat4& t_mesh_world, const bool meshlets)
+{
+    MeshGeometry geometry;
+    auto arrays = std::make_shared<std::vector<MeshArrays>>();
 
     glm::mat4 t_node_world(1.0f);
-    addNode(source, source->mRootNode, t_node_world, t_mesh_world);
+    MeshOptimizerStats stats;
+    addNode(geometry.meshData, *arrays, source, source->mRootNode, t_node_world, t_mesh_world, stats);
+
+    LOG_INFO << "Mesh optimized: " << stats.numVerticesBefore << " -> " << stats.numVerticesAfter << " vertices, "
+             << stats.numTrianglesBefore << " -> " << stats.numTrianglesAfter << " triangles, ACMR "
+             << stats.acmrBefore() << " -> " << stats.acmrAfter();
+
+    // the arrays are complete, the sub-meshes only view them
+    for (size_t i = 0; i < geometry.meshData.size(); ++i) {
+        auto& meshData = geometry.meshData[i];
+        auto& meshArrays = (*arrays)[i];
+        meshData.vertices = meshArrays.vertices;
+        meshData.indices = meshArrays.indices;
+        for (const auto& lod : meshArrays.lods)
+            meshData.lods.emplace_back(lod.indices, lod.error);
+
+        if (meshlets) {
+            meshArrays.meshlets = buildMeshlets(meshData);
+            meshData.meshlets = meshArrays.meshlets;
+        }
+    }
 
-    const size_t numVertices = std::accumulate(m_meshData.begin(), m_meshData.end(), 0, [](const size_t sum, const MeshData& meshData) {
-        return sum + meshData.vertices.size();
-    });
+    size_t numTriangles = 0;
+    for (const auto& meshData : geometry.meshData) {
+        numTriangles += meshData.indices.size();
+        geometry.bb.grow(meshData.bb);
+    }
 
-    m_triData = std::make_shared<TriangulationData>();
-    m_triData->vertices.resize(numVertices);
-    for (const auto& meshData : m_meshData)
-        m_triData->indices.insert(m_triData->indices.end(), meshData.indices.begin(), meshData.indices.end());
-    updateTriangulationData();
+    // the bvh sees the quantized positions, picking hits what is drawn
+    std::vector<std::array<glm::vec3, 3>> triangles;
+    triangles.reserve(numTriangles);
+    for (const auto& meshData : geometry.meshData)
+        for (const auto& indices : meshData.indices)
+            triangles.push_back({
+                meshData.position(indices[0]), 
+                meshData.position(indices[1]), 
+                meshData.position(indices[2])
+            });
+    geometry.bvh.build(triangles);
+
+    geometry.storage = std::move(arrays);
+    return geometry;
+}
 
-    createBuffers();
+std::vector<Meshlet> Mesh::buildMeshlets(const MeshData& meshData)
+{
+    std::vector<Meshlet> meshlets;
+
+    // greedy over the current triangle order, a meshlet is closed once it would exceed either limit
+    std::vector<uint32_t> lastMeshlet(meshData.vertices.size(), std::numeric_limits<uint32_t>::max());
+    Meshlet meshlet{ 0, 0, {} };
+    size_t numVertices = 0;
+
+    for (uint32_t i = 0; i < meshData.indices.size(); ++i) {
+        const auto& triangle = meshData.indices[i];
+        const uint32_t id = static_cast<uint32_t>(meshlets.size());
+
+        size_t numNew = 0;
+        for (const uint32_t index : triangle)
+            numNew += lastMeshlet[index] != id;
+
+        if (numVertices + numNew > s_meshletMaxVertices || meshlet.numTriangles == s_meshletMaxTriangles) {
+            meshlets.push_back(meshlet);
+            meshlet = Meshlet{ i, 0, {} };
+            numVertices = 0;
+        }
+
+        const uint32_t current = static_cast<uint32_t>(meshlets.size());
+        for (const uint32_t index : triangle) {
+            if (lastMeshlet[index] != current) {
+                lastMeshlet[index] = current;
+                numVertices++;
+            }
+            meshlet.bb.grow(meshData.position(index));
+        }
+        meshlet.numTriangles++;
+    }
+
+    if (meshlet.numTriangles > 0)
+        meshlets.push_back(meshlet);
+    return meshlets;
 }
 
-Mesh::~Mesh() = default;
+void Mesh::setAsset(const std::shared_ptr<MeshAsset>& asset)
+{
+    assert(!m_asset && "Mesh asset already set");
+
+    m_asset = asset;
+    if (m_asset->poll() && m_asset->getGeometry())
+        setupInstance();
+}
+
+void Mesh::setGeometry(const std::shared_ptr<const MeshGeometry>& geometry)
+{
+    setAsset(std::make_shared<MeshAsset>(geometry));
+}
+
+bool Mesh::upload(const bool limited)
+{
+    if (!m_asset)
+        return true;
+    if (!m_asset->poll())
+        return false;
+    if (!m_asset->getGeometry())
+        return true;
+
+    if (!m_triData)
+        setupInstance();
+    return m_asset->upload(limited);
+}
+
+void Mesh::setupInstance()
+{
+    m_localBB = m_asset->getGeometry()->bb;
+    m_lod = 0;
+
+    // world-space triangles are only built if someone asks for them
+    m_triData = std::make_shared<TriangulationData>();
+    invalidateTriangulationData();
+}
 
 void Mesh::draw(const Camera& camera, const bool drawBB)
 {
     draw(camera);
 
-    if (m_visible && drawBB)
+    if (m_visible && drawBB && m_asset && m_asset->numUploaded() > 0)
         drawBoundingBox(camera);
 }
 
 void Mesh::draw(const Camera& camera)
 {
-    if (!m_visible)
+    if (!m_visible || !m_triData)
         return;
 
-    updateMvp(camera);
-
-    for (const auto& va : m_vertexArrays)
-        Renderer::draw(m_shader, va);
+    drawMeshes(camera);
 }
 
 void Mesh::updateTriangulationData()
 {
-    m_limitsX[0] = m_limitsY[0] = m_limitsZ[0] = std::numeric_limits<float>::max();
-    m_limitsX[1] = m_limitsY[1] = m_limitsZ[1] = std::numeric_limits<float>::min();
-
-    size_t i = 0;
-    for (const auto& meshData : m_meshData) {
-        for (const auto& vertices : meshData.vertices) {
-            m_triData->vertices[i] = glm::vec4{vertices.pos, 1.0f} * m_model;
-
-            m_limitsX[0] = std::min(m_limitsX[0], m_triData->vertices[i].x);
-            m_limitsX[1] = std::max(m_limitsX[1], m_triData->vertices[i].x);
-            m_limitsY[0] = std::min(m_limitsY[0], m_triData->vertices[i].y);
-            m_limitsY[1] = std::max(m_limitsY[1], m_triData->vertices[i].y);
-            m_limitsZ[0] = std::min(m_limitsZ[0], m_triData->vertices[i].z);
-            m_limitsZ[1] = std::max(m_limitsZ[1], m_triData->vertices[i++].z);
+    const auto& geometry = m_asset->getGeometry();
+    if (m_triData->indices.empty()) {
+        uint32_t offset = 0;
+        for (const auto& meshData : geometry->meshData) {
+            for (const auto& indices : meshData.indices)
+                m_triData->indices.push_back({
+                    indices[0] + offset, 
+                    indices[1] + offset, 
+                    indices[2] + offset
+                });
+            offset += meshData.vertices.size();
         }
+        m_triData->vertices.resize(offset);
     }
 
-    updateBoundingBox();
+    size_t i = 0;
+    for (const auto& meshData : geometry->meshData)
+        for (size_t j = 0; j < meshData.vertices.size(); ++j)
+            m_triData->vertices[i++] = glm::vec4{meshData.position(j), 1.0f} * m_model;
 }
 
 bool Mesh::rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const
 {
+    if (!hasGeometry())
+        return false;
+
     const auto& [v_ray_world, p_ray_world] = ray_world;
 
-    bool hit = false;
-    for (const auto& indices : m_bbData.indices) {
-        std::array<glm::vec3, 3> p_vertices_world;
-        for (size_t i = 0; i < 3; ++i)
-            p_vertices_world[i] = m_bbData.vertices[indices[i]];
+    // transform the ray into mesh space instead of the vertices into world space
+    const glm::mat4 t_world_mesh = glm::inverse(m_model);
+    const glm::vec3 p_ray_mesh = glm::vec4(p_ray_world, 1.0f) * t_world_mesh;
+    const glm::vec3 v_ray_mesh = glm::vec4(v_ray_world, 0.0f) * t_world_mesh;
 
-        const auto[n_tri_world, p_tri_world] = trianglePlane(p_vertices_world);
-        glm::vec3 p_hitTmp_world;                               
-        if (intersectionLinePlane(n_tri_world, p_tri_world, v_ray_world, p_ray_world, p_hitTmp_world) && 
-            pointInTriangle(n_tri_world, p_tri_world, p_vertices_world, p_hitTmp_world)) {   
+    // the ray parameter is the same in both spaces as long as the direction is not renormalized
+    float t;
+    if (!m_asset->getGeometry()->bvh.intersect(p_ray_mesh, v_ray_mesh, t))
+        return false;
+
+    p_hit_world = p_ray_world + t*v_ray_world;
+    minDist = t*glm::length(v_ray_world);
+    return true;
+}
 
-            hit = true;
-            break;
+void Mesh::drawMeshes(const Camera& camera)
+{
+    selectLod(camera);
+
+    // the dequantization differs per sub-mesh and only applies to positions, the normals are stored in mesh space,
+    // instances of the same asset and level end up in one draw
+    const glm::mat4 model = glm::transpose(m_model);
+    const auto& geometry = m_asset->getGeometry();
+
+    // meshlets are tested in mesh space, their bounds are never transformed
+    const Frustum frustum_mesh = Scene::getFrustum().transformed(m_model);
+    auto& stats = Scene::getCullingStats();
+
+    for (size_t i = 0; i < m_asset->numUploaded(); ++i) {
+        const auto& meshData = geometry->meshData[i];
+        const InstanceData instance(model, m_color.value_or(meshData.color), glm::vec4(meshData.bb.max - meshData.bb.min, 1.0f), glm::vec4(meshData.bb.min, 0.0f));
+        DrawPacket packet(m_shader.get(), nullptr, &m_asset->getVertexArray(i, m_lod), 0, 0, instance);
+
+        // meshlets only partition the full resolution indices, a sub-mesh completely in view needs no tests
+        const bool fullResolution = std::min(m_lod, meshData.lods.size()) == 0;
+        if (!fullResolution || meshData.meshlets.empty() || frustum_mesh.contains(meshData.bb)) {
+            Renderer::submit(packet);
+            continue;
         }
-    }
 
-    if (!hit)
-        return false;
+        // neighbouring meshlets are neighbouring index ranges, every run of visible ones is a single packet
+        packet.numIndices = 0;
+        for (const auto& meshlet : meshData.meshlets) {
+            stats.meshletsTested++;
+            if (frustum_mesh.intersects(meshlet.bb)) {
+                if (packet.numIndices == 0)
+                    packet.firstIndex = 3*meshlet.firstTriangle;
+                packet.numIndices += 3*meshlet.numTriangles;
+                continue;
+            }
 
-    return Entity::rayIntersection(ray_world, p_hit_world, minDist);
+            stats.meshletsCulled++;
+            if (packet.numIndices > 0)
+                Renderer::submit(packet);
+            packet.numIndices = 0;
+        }
+        if (packet.numIndices > 0)
+            Renderer::submit(packet);
+    }
 }
 
-void Mesh::updateBoundingBox()
+void Mesh::selectLod(const Camera& camera)
 {
-    m_bbData.vertices[0] = glm::vec3{m_limitsX[0], m_limitsY[0], m_limitsZ[0]};
-    m_bbData.vertices[1] = glm::vec3{m_limitsX[1], m_limitsY[0], m_limitsZ[0]};
-    m_bbData.vertices[2] = glm::vec3{m_limitsX[1], m_limitsY[1], m_limitsZ[0]};
-    m_bbData.vertices[3] = glm::vec3{m_limitsX[0], m_limitsY[1], m_limitsZ[0]};
-    m_bbData.vertices[4] = glm::vec3{m_limitsX[0], m_limitsY[0], m_limitsZ[1]};
-    m_bbData.vertices[5] = glm::vec3{m_limitsX[1], m_limitsY[0], m_limitsZ[1]};
-    m_bbData.vertices[6] = glm::vec3{m_limitsX[1], m_limitsY[1], m_limitsZ[1]};
-    m_bbData.vertices[7] = glm::vec3{m_limitsX[0], m_limitsY[1], m_limitsZ[1]};
+    const auto& lodErrors = m_asset->getLodErrors();
+    const auto [width, height] = ImGuiLayer::getViewportSize();
+    if (lodErrors.size() < 2 || height == 0 || !m_localBB.isValid())
+        return;
+
+    // pixels per mesh unit at the bounding box center, w is the view depth for a perspective projection and 1 otherwise
+    const glm::vec3 p_center_mesh = 0.5f*(m_localBB.min + m_localBB.max);
+    const glm::vec4 p_center_clip = camera.getProjection() * camera.getView() * glm::transpose(m_model) * glm::vec4(p_center_mesh, 1.0f);
+    const float pixelsPerUnit = camera.getProjection()[1][1] * 0.5f*height / std::max(p_center_clip.w, 1e-3f);
+
+    while (m_lod + 1 < lodErrors.size() && lodErrors[m_lod + 1]*pixelsPerUnit < s_lodPixelError*(1.0f - s_lodHysteresis))
+        m_lod++;
+    while (m_lod > 0 && lodErrors[m_lod]*pixelsPerUnit > s_lodPixelError)
+        m_lod--;
 }
 
-void Mesh::drawBoundingBox(const Camera& camera)
+void Mesh::drawBoundingBox(const Camera& /*camera*/)
 {
-    const glm::mat4 mvp = camera.getProjection() * camera.getView() * glm::transpose(m_model);
-
-    m_shaderBB->bind();
-    m_shaderBB->uploadMat4("u_mvp", mvp);
-    m_shaderBB->uploadVec4("u_color", {0.0f, 1.0f, 0.0, 1.0f});
-    Renderer::draw(m_shaderBB, m_vertexArrayBB);
+    Renderer::submit(m_shaderBB, m_asset->getBoundingBoxVertexArray(), glm::transpose(m_model), {0.0f, 1.0f, 0.0f, 1.0f});
 }
 
-void Mesh::addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_world, const glm::mat4& t_mesh_world)
+void Mesh::addNode(std::vector<MeshData>& meshDataList, std::vector<MeshArrays>& meshArrayList, const aiScene* source, const aiNode* node, glm::mat4 t_node_world, const glm::mat4& t_mesh_world, MeshOptimizerStats& stats)
 {
     glm::mat4 t_curr_world = convertMat4<aiMatrix4x4, glm::mat4>(node->mTransformation);
     setMat4Translation(t_curr_world, 1000.0f*getMat4Translation(t_curr_world));
@@ -136,6 +500,7 @@ void Mesh::addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_w
 
     for (size_t i = 0; i < node->mNumMeshes; ++i) {
         MeshData meshData;
+        MeshArrays meshArrays;
         const auto& meshSource = source->mMeshes[node->mMeshes[i]];
 
         glm::vec4 color(0.4f, 0.4f, 0.4f, 1.0f);
@@ -146,9 +511,11 @@ void Mesh::addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_w
         else 
             LOG_WARN << "Material not valid: " << meshSource->mMaterialIndex;
 
-        meshData.vertices.resize(meshSource->mNumVertices);
-        for (size_t j = 0; j < meshData.vertices.size(); ++j) {
-            auto& vertex = meshData.vertices[j];
+        meshData.color = color;
+
+        std::vector<glm::vec3> positions(meshSource->mNumVertices);
+        std::vector<glm::vec3> normals(meshSource->mNumVertices, glm::vec3(0.0f, 0.0f, 1.0f));
+        for (size_t j = 0; j < positions.size(); ++j) {
             auto& vertSource = meshSource->mVertices[j];
 
             glm::vec3 p_vertex_world;
@@ -156,15 +523,19 @@ void Mesh::addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_w
             p_vertex_world.y = 1000.0f*vertSource.y;
             p_vertex_world.z = 1000.0f*vertSource.z;  
 
-            p_vertex_world = glm::vec4(p_vertex_world, 1.0f) * t_node_world * t_mesh_world;
+            positions[j] = glm::vec4(p_vertex_world, 1.0f) * t_node_world * t_mesh_world;
 
-            vertex.pos = p_vertex_world;
-            vertex.color = color;
+            if (meshSource->HasNormals()) {
+                const auto& normalSource = meshSource->mNormals[j];
+                const glm::vec3 n = glm::vec4(normalSource.x, normalSource.y, normalSource.z, 0.0f) * t_node_world * t_mesh_world;
+                if (glm::length(n) > 0.0f)
+                    normals[j] = glm::normalize(n);
+            }
         }
 
-        meshData.indices.resize(meshSource->mNumFaces);
-        for (size_t j = 0; j < meshData.indices.size(); ++j) {
-            auto& indices = meshData.indices[j];
+        meshArrays.indices.resize(meshSource->mNumFaces);
+        for (size_t j = 0; j < meshArrays.indices.size(); ++j) {
+            auto& indices = meshArrays.indices[j];
             auto& indexSource = meshSource->mFaces[j];
 
             if (indexSource.mNumIndices != 3)
@@ -174,44 +545,32 @@ void Mesh::addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_w
                 indices[k] = indexSource.mIndices[k];
         }
 
-        m_meshData.push_back(meshData);
-    }
+        MeshOptimizer::optimize(positions, normals, meshArrays.indices, stats);
 
-    for (size_t i = 0; i < node->mNumChildren; ++i)
-        addNode(source, node->mChildren[i], t_node_world, t_mesh_world);
-}
+        for (const auto& p : positions)
+            meshData.bb.grow(p);
 
-void Mesh::createBuffers()
-{
-    m_vertexArrays.resize(m_meshData.size());
-    for (size_t i = 0; i < m_vertexArrays.size(); ++i) {
-        auto& vertices = m_meshData[i].vertices;
-        auto& indices = m_meshData[i].indices;
-        auto& vertexArray = m_vertexArrays[i];
+        meshArrays.lods = MeshOptimizer::simplify(positions, normals, meshArrays.indices, s_lodRatios, s_lodMaxError*glm::length(meshData.bb.max - meshData.bb.min));
 
-        std::shared_ptr<VertexBuffer> vertexBuffer = std::make_shared<VertexBuffer>();
-        vertexBuffer->allocate(reinterpret_cast<float*>(vertices.data()), vertices.size() * sizeof(MeshData::Vertex)/sizeof(float));
-        BufferLayout layout = {
-            { ShaderDataType::Float3, "a_position" },
-            { ShaderDataType::Float4, "a_color" }
-        };
-        vertexBuffer->setLayout(layout);
-        vertexArray.addVertexBuffer(vertexBuffer);
+        // a flat sub-mesh still needs a non zero extent to quantize against
+        const glm::vec3 extent = glm::max(meshData.bb.max - meshData.bb.min, glm::vec3(std::numeric_limits<float>::min()));
+        meshData.bb.max = meshData.bb.min + extent;
 
-        std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
-        indexBuffer->allocate(indices.data()->data(), 3*indices.size());
-        vertexArray.setIndexBuffer(indexBuffer);
-    }
+        meshArrays.vertices.resize(positions.size());
+        for (size_t j = 0; j < meshArrays.vertices.size(); ++j) {
+            auto& vertex = meshArrays.vertices[j];
 
-    std::shared_ptr<VertexBuffer> vertexBuffer = std::make_shared<VertexBuffer>();
-    vertexBuffer->allocate(reinterpret_cast<const GLfloat*>(m_bbData.vertices.data()), m_bbData.vertices.size() * 3);
-    BufferLayout layout = {
-        { ShaderDataType::Float3, "a_position" }
-    };
-    vertexBuffer->setLayout(layout);
-    m_vertexArrayBB.addVertexBuffer(vertexBuffer);
+            const glm::vec3 p_normalized = glm::clamp((positions[j] - meshData.bb.min) / extent, 0.0f, 1.0f);
+            for (size_t k = 0; k < 3; ++k)
+                vertex.pos[k] = static_cast<uint16_t>(std::round(p_normalized[k] * 65535.0f));
 
-    std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
-    indexBuffer->allocate(reinterpret_cast<const GLushort*>(m_bbData.indices.data()), 3*m_bbData.indices.size());
-    m_vertexArrayBB.setIndexBuffer(indexBuffer);
+            vertex.normal = octEncode(normals[j]);
+        }
+
+        meshDataList.push_back(std::move(meshData));
+        meshArrayList.push_back(std::move(meshArrays));
+    }
+
+    for (size_t i = 0; i < node->mNumChildren; ++i)
+        addNode(meshDataList, meshArrayList, source, node->mChildren[i], t_node_world, t_mesh_world, stats);
 }
\ No newline at end of file
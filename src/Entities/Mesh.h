@@ -4,6 +4,9 @@
 
 #include "Renderer/VertexArray.h"
 
+#include "Util/Bvh.h"
+#include "Util/MeshOptimizer.h"
+
 struct BoundingBoxData
 {
     std::array<glm::vec3, 8> vertices;
@@ -23,46 +26,188 @@ struct BoundingBoxData
     };
 };
 
+// contiguous triangle range of a sub-mesh with few enough vertices to stay in the post-transform cache
+struct Meshlet
+{
+    uint32_t firstTriangle;
+    uint32_t numTriangles;
+    BoundingBox bb;
+};
+
+// positions are unorm16 relative to bb, normals octahedral snorm8, the arrays are views into the storage of the geometry
 struct MeshData
 {
     struct Vertex
     {
-        glm::vec3 pos;
-        glm::vec4 color;
+        std::array<uint16_t, 3> pos;
+        std::array<int8_t, 2> normal;
     };
 
-    std::vector<Vertex> vertices;
-    std::vector<std::array<uint16_t, 3>> indices;
+    struct Lod
+    {
+        std::span<const std::array<uint32_t, 3>> indices;
+        float error;
+    };
+
+    std::span<const Vertex> vertices;
+    std::span<const std::array<uint32_t, 3>> indices;
+    std::span<const Meshlet> meshlets;
+    std::vector<Lod> lods;
+    BoundingBox bb;
+    glm::vec4 color;
+
+    glm::vec3 position(const size_t i) const;
+};
+
+// owned arrays of an imported sub-mesh
+struct MeshArrays
+{
+    std::vector<MeshData::Vertex> vertices;
+    std::vector<std::array<uint32_t, 3>> indices;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshLod> lods;
+};
+
+static_assert(sizeof(MeshData::Vertex) == 8, "Unexpected vertex padding");
+
+// cpu side result of an import, safe to build off the render thread
+struct MeshGeometry
+{
+    std::vector<MeshData> meshData;
+    BoundingBox bb;
+    Bvh bvh;
+
+    // keeps the arrays of meshData and the bvh alive, the imported MeshArrays or a mapped cache file
+    std::shared_ptr<const void> storage;
+};
+
+// immutable geometry and its gpu buffers, shared by every mesh entity showing the same content
+class MeshAsset
+{
+public:
+    MeshAsset(std::future<std::shared_ptr<MeshGeometry>>&& import, const std::filesystem::path& file = {}, const uint64_t hash = 0);
+    MeshAsset(const std::shared_ptr<const MeshGeometry>& geometry, const std::filesystem::path& file = {}, const uint64_t hash = 0);
+    ~MeshAsset() = default;
+
+    // true once the import has finished, failed imports leave the geometry empty
+    bool poll();
+    void wait();
+
+    // one sub-mesh at a time, big meshes are spread over several frames
+    bool upload(const bool limited = true);
+
+    inline const std::shared_ptr<const MeshGeometry>& getGeometry() const { return m_geometry; }
+    inline bool isUploaded() const { return m_geometry && m_numUploaded == m_geometry->meshData.size(); }
+    inline size_t numUploaded() const { return m_numUploaded; }
+
+    // sub-meshes with fewer levels keep drawing their coarsest one
+    inline const VertexArray& getVertexArray(const size_t i, const size_t level) const { return m_vertexArrays[i][std::min(level, m_vertexArrays[i].size() - 1)]; }
+    inline const VertexArray& getBoundingBoxVertexArray() const { return m_vertexArrayBB; }
+    inline const std::vector<float>& getLodErrors() const { return m_lodErrors; }
+
+    inline const std::filesystem::path& getFile() const { return m_file; }
+    inline uint64_t getHash() const { return m_hash; }
+
+private:
+    void setGeometry(const std::shared_ptr<const MeshGeometry>& geometry);
+
+    void createBuffers(const size_t i);
+    void createBoundingBoxBuffers();
+
+    std::future<std::shared_ptr<MeshGeometry>> m_import;
+    std::shared_ptr<const MeshGeometry> m_geometry;
+
+    // per sub-mesh, full resolution first and then the coarser levels
+    std::vector<std::vector<VertexArray>> m_vertexArrays;
+    size_t m_numUploaded;
+
+    // largest error of any sub-mesh per level, level 0 is exact
+    std::vector<float> m_lodErrors;
+
+    BoundingBoxData m_bbData;
+    VertexArray m_vertexArrayBB;
+
+    std::filesystem::path m_file;
+    uint64_t m_hash;
+};
+
+// assets by content hash, an entry lives as long as some mesh entity holds its asset
+class MeshLibrary
+{
+public:
+    // imports on the thread pool, hash is computeHash() of the file, an unshared asset is never handed out again
+    static std::shared_ptr<MeshAsset> load(const std::filesystem::path& file, const uint64_t hash, const bool shared = true);
+
+    // geometry read from a cache, an asset still alive for the same content wins
+    static std::shared_ptr<MeshAsset> add(const std::filesystem::path& file, const uint64_t hash, const std::shared_ptr<const MeshGeometry>& geometry);
+
+    static std::shared_ptr<MeshAsset> get(const uint64_t hash);
+    inline static bool exists(const uint64_t hash) { return get(hash) != nullptr; }
+
+    static uint64_t computeHash(const std::filesystem::path& file);
+    static size_t numAssets();
+
+private:
+    static std::unordered_map<uint64_t, std::weak_ptr<MeshAsset>> s_assets;
 };
 
 class Mesh : public Entity {
 
 public:
+    Mesh();
     Mesh(const aiScene* source, const glm::mat4& t_mesh_world = glm::mat4(1.0f));
     virtual ~Mesh();
 
+    static std::shared_ptr<MeshGeometry> import(const std::filesystem::path& file, const glm::mat4& t_mesh_world = glm::mat4(1.0f), const bool meshlets = true);
+    static MeshGeometry createGeometry(const aiScene* source, const glm::mat4& t_mesh_world = glm::mat4(1.0f), const bool meshlets = true);
+    static std::vector<Meshlet> buildMeshlets(const MeshData& meshData);
+
+    void setAsset(const std::shared_ptr<MeshAsset>& asset);
+    void setGeometry(const std::shared_ptr<const MeshGeometry>& geometry);
+
+    // drives the asset import and upload, true once there is nothing left to do
+    bool upload(const bool limited = true);
+
     void draw(const Camera& camera, const bool drawBB);
     virtual void draw(const Camera& camera) override;
-    
-    virtual void updateTriangulationData() override;
 
-    inline virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const override;
+    virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const override;
+
+    // replaces the material colors of all sub-meshes
+    inline void setColor(const std::optional<glm::vec4>& color) { m_color = color; }
+
+    inline const std::shared_ptr<MeshAsset>& getAsset() const { return m_asset; }
+    inline std::shared_ptr<const MeshGeometry> getGeometry() const { return m_asset ? m_asset->getGeometry() : nullptr; }
+    inline const Bvh& getBvh() const { return m_asset->getGeometry()->bvh; }
+    inline bool hasGeometry() const { return m_asset && m_asset->getGeometry(); }
+    inline bool isUploaded() const { return m_asset && m_asset->isUploaded(); }
+    inline size_t getLod() const { return m_lod; }
+
+protected:
+    virtual void updateTriangulationData() override;
 
 private:
-    void updateBoundingBox();
+    void setupInstance();
+    void selectLod(const Camera& camera);
+    void drawMeshes(const Camera& camera);
     void drawBoundingBox(const Camera& camera);
 
-    void addNode(const aiScene* source, const aiNode* node, glm::mat4 t_node_world, const glm::mat4& t_mesh_world);
+    static void addNode(std::vector<MeshData>& meshData, std::vector<MeshArrays>& meshArrays, const aiScene* source, const aiNode* node, glm::mat4 t_node_world, const glm::mat4& t_mesh_world, MeshOptimizerStats& stats);
 
-    void createBuffers();
-
-    std::vector<MeshData> m_meshData;
-    std::vector<VertexArray> m_vertexArrays;
+    std::shared_ptr<MeshAsset> m_asset;
+    std::optional<glm::vec4> m_color;
+    size_t m_lod;
     
     std::shared_ptr<Shader> m_shaderBB;
-    glm::vec2 m_limitsX;
-    glm::vec2 m_limitsY;
-    glm::vec2 m_limitsZ;
-    BoundingBoxData m_bbData;
-    VertexArray m_vertexArrayBB;   
+
+    inline static constexpr size_t s_meshletMaxVertices = 64;
+    inline static constexpr size_t s_meshletMaxTriangles = 124;
+
+    // lod triangle ratios, the allowed simplification error is relative to the sub-mesh diagonal
+    inline static constexpr std::array<float, 3> s_lodRatios = { 0.5f, 0.25f, 0.125f };
+    inline static constexpr float s_lodMaxError = 0.02f;
+
+    // a level is used while its error stays below a pixel, switching to a coarser level needs some margin
+    inline static constexpr float s_lodPixelError = 1.0f;
+    inline static constexpr float s_lodHysteresis = 0.25f;
 };
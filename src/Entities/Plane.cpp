@@ -9,23 +9,16 @@ Plane::Plane(const std::variant<std::shared_ptr<Texture2D>, glm::vec4>& material
     : m_material(material)
 {
     if (hasTexture())
-        if (ShaderLibrary::exists("Texture"))
-            m_shader = ShaderLibrary::get("Texture");
-        else
-            m_shader = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/Texture", "Texture");
+        m_shader = ShaderLibrary::get("Texture");
     else
-        if (ShaderLibrary::exists("FlatColor"))
-            m_shader = ShaderLibrary::get("FlatColor");
-        else
-            m_shader = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/FlatColor", "FlatColor");
+        m_shader = ShaderLibrary::get("FlatColor");
 
     m_triData = std::make_shared<TriangulationData>();
-    m_triData->indices = std::vector {
-        s_indices[0],
-        s_indices[1]
-    };
+    for (const auto& indices : s_indices)
+        m_triData->indices.push_back({ indices[0], indices[1], indices[2] });
     m_triData->vertices.resize(s_vertices.size());
-    updateTriangulationData();
+    for (const auto& p_vertex : s_vertices)
+        m_localBB.grow(p_vertex);
 
     createBuffers();
 }
@@ -35,19 +28,15 @@ Plane::~Plane()
     m_vertexArray.release();
 }
 
-void Plane::draw(const Camera& camera)
+void Plane::draw(const Camera& /*camera*/)
 {
     if (!m_visible)
         return;
 
-    updateMvp(camera);
-
     if (hasTexture())
-        std::get<std::shared_ptr<Texture2D>>(m_material)->bind();
+        Renderer::submit(m_shader, m_vertexArray, glm::transpose(m_model), glm::vec4(1.0f), std::get<std::shared_ptr<Texture2D>>(m_material));
     else
-        m_shader->uploadVec4("u_color", std::get<glm::vec4>(m_material));
-        
-    Renderer::draw(m_shader, m_vertexArray);
+        Renderer::submit(m_shader, m_vertexArray, glm::transpose(m_model), std::get<glm::vec4>(m_material));
 }
 
 void Plane::updateTriangulationData()
@@ -13,6 +13,8 @@ public:
     virtual ~Plane();
 
     virtual void draw(const Camera& camera) override;
+
+protected:
     virtual void updateTriangulationData() override;
 
 private:   
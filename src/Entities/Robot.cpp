@@ -4,17 +4,27 @@
 
 #include "Mesh.h"
 #include "Frame.h"
+#include "RobotCache.h"
+#include "TrajectoryFile.h"
+#include "UrdfReader.h"
+
+#include "Scene.h"
+#include "Simulation.h"
+
+#include "Renderer/Renderer.h"
 
 #include "ImGui/ImGuiLayer.h"
 
 #include "Util/geometry.h"
 #include "Util/Log.h"
+#include "Util/MappedFile.h"
+#include "Util/ThreadPool.h"
 
 Robot::Robot() = default;
 
 Robot::~Robot() = default;
 
-bool Robot::setup(const std::filesystem::path& sourceDir)
+bool Robot::setup(const std::filesystem::path& sourceDir, const bool useCache, const bool shareMeshes)
 {
     if (!std::filesystem::exists(sourceDir)) {
         LOG_ERROR << "Robot model directory invalid.";
@@ -28,108 +38,94 @@ bool Robot::setup(const std::filesystem::path& sourceDir)
 		return false;
     }
 
-    std::string urdfContent;
+    std::filesystem::path urdfFile;
     for (const auto& entry : std::filesystem::directory_iterator(urdfDir)) {
         if (entry.path().extension() == ".urdf") {
-            urdfContent = readFile(entry.path());
+            urdfFile = entry.path();
             break;
         }
     }
-    if (urdfContent.empty()) {
-        LOG_ERROR << "Robot model directory does not contain valid urdf-data.";
-		return false;
-    }
-
-    // parse urdf file
-    XmlLexer urdfLexer(urdfContent);
-    XmlParser urdfParser(urdfLexer.generateTokens());
 
-    // root
-    const XmlNode urdfRoot = urdfParser.parse();
-    if (urdfRoot.children.size() != 1 || urdfRoot.children.front().tag != "robot") {
-        LOG_ERROR << "Invalid urdf format.";
-		return false;
-    }
+    m_sourceDir = sourceDir;
+    m_cacheFile = RobotCache::getPath(sourceDir);
+    std::unordered_map<std::string, uint64_t> meshHashes;
+    m_cacheHash = RobotCache::computeHash(urdfFile, meshDir, meshHashes);
+    if (useCache)
+        if (const auto cache = RobotCache::read(m_cacheFile, m_cacheHash); cache)
+            return setupFromCache(*cache, shareMeshes);
 
-    // robot
-    const XmlNode robotNode = urdfRoot.children.front();
-    if (auto it = robotNode.attributes.find("name"); it == robotNode.attributes.cend() || it->second.index() != 2) {
-        LOG_ERROR << "Invalid robot tag.";
+    const MappedFile urdfContent(urdfFile);
+    if (urdfFile.empty() || !urdfContent.isOpen()) {
+        LOG_ERROR << "Robot model directory does not contain valid urdf-data.";
 		return false;
     }
-    m_name = std::get<std::string>(robotNode.attributes.at("name"));
-    LOG_INFO << "adding Robot: " << m_name;
-    
-    // links/joints
-    for (const auto& node : robotNode.children) {
-        if (auto it = node.attributes.find("name"); it != node.attributes.cend() && it->second.index() == 2) {
-            const std::string name = std::get<std::string>(it->second);
 
-            // link
-            if (node.tag == "link") {
+    // parse urdf file, links are set up while streaming, joints once all links are known
+    UrdfReader urdfReader([this, &meshDir, &meshHashes, shareMeshes](const UrdfLink& link) { return setupLink(link, meshDir, meshHashes, shareMeshes); });
+    if (!urdfReader.read(std::string_view(urdfContent.data(), urdfContent.size())))
+        return false;
 
-                if(!setupLink(name, meshDir, node))
-                    return false;
+    m_name = urdfReader.getName();
+    LOG_INFO << "adding Robot: " << m_name;
 
-                // return true;
-            }
-            // joint
-            else if (node.tag == "joint") {
-
-                if(!setupJoint(name, node))
-                    return false;
-                
-            }
-        }
-    }
+    for (const auto& joint : urdfReader.getJoints())
+        setupJoint(joint);
+    buildKinematics();
 
     m_controlData.drawFrames = true;
     m_controlData.drawBoundingBoxes = false;
+    m_writeCache = true;
     return true;
 }
 
-void Robot::update(const Timestep dt)
+void Robot::step(const double time, const Timestep dt)
 {
-    if (m_controlData.trajectory) {
-        auto& [active, currentTime, currentIndex, jointValues, times] = *m_controlData.trajectory; 
-
-        while (currentTime > times[currentIndex] && currentIndex < jointValues.size())
-            currentIndex++;
-        while (currentTime < times[currentIndex-1] && currentIndex > 0)
-            currentIndex--;
-
-        if (active && m_controlData.trajectory->currentTime < m_controlData.trajectory->times.back()) {
-            currentTime += dt;
-
-            if (currentIndex > 0 && currentIndex < jointValues.size())
-                for (size_t i = 0; i < numJoints(); ++i) {           
-                    m_controlData.jointValues[i] = map(
-                        currentTime, 
-                        times[currentIndex-1],          times[currentIndex], 
-                        jointValues[currentIndex-1][i], jointValues[currentIndex][i]); 
-                } 
-        }
-        else if (active)
-            active = false;
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        advanceTrajectory(dt);
+        std::copy(m_controlData.jointValues.begin(), m_controlData.jointValues.end(), m_stepJointValues.begin());
+    }
+
+    auto& snapshot = m_snapshots.writeBuffer();
+    snapshot.time = time;
+    m_kinematics.evaluate(m_stepJointValues, glm::mat4(1.0f), snapshot.t_link_base);
+    m_snapshots.publish();
+}
+
+void Robot::update()
+{
+    streamMeshes();
+    streamTrajectory();
+
+    if (m_snapshots.hasUpdate()) {
+        m_previousSnapshot = m_snapshots.read();
+        m_snapshots.update();
     }
 
-    forwardTransform();
+    // one step behind the simulation clock, there is usually a newer snapshot to interpolate towards
+    forwardTransform(Simulation::now() - Simulation::s_step);
 }
 
 void Robot::draw(const Camera& camera)
 {
-    for (auto&[name, entity] : m_entities)
+    // the scene already culled the robot as a whole
+    const auto& frustum = Scene::getFrustum();
+    auto& stats = Scene::getCullingStats();
+    for (auto&[name, entity] : m_entities) {
+        if (!entity->isVisible())
+            continue;
+
+        stats.linksTested++;
+        if (!frustum.intersects(entity->getBoundingBox())) {
+            stats.linksCulled++;
+            continue;
+        }
+
         if (auto mesh = dynamic_cast<Mesh*>(entity.get()); mesh != nullptr)
             mesh->draw(camera, m_controlData.drawBoundingBoxes);
         else
             entity->draw(camera);
-}
-
-void Robot::updateTriangulationData()
-{
-    for (auto&[name, entity] : m_entities)
-        if (auto mesh = dynamic_cast<Mesh*>(entity.get()); mesh != nullptr)
-            mesh->updateTriangulationData();
+    }
 }
 
 bool Robot::rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const
@@ -153,123 +149,180 @@ bool Robot::rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, g
 
 void Robot::loadTrajectory(const std::filesystem::path& file)
 {
-    std::ifstream in(file);
-    if (!in) {
-        LOG_ERROR << "Failed to open trajectory file: " << file;
+    if (isLoadingTrajectory()) {
+        LOG_WARN << "Still loading a trajectory, ignoring: " << file;
         return;
     }
 
-    Trajectory traj;
-    std::string line;
-    while (std::getline(in, line)) {
-        const auto parts = splitString(line, ";, ");
-        std::vector<float> jointValues(numJoints());
-        for (size_t i = 0; i < numJoints(); ++i) {
-            jointValues[i] = std::stof(parts[i]);
+    // a text file is converted once, later loads map the binary next to it as long as it is newer
+    std::filesystem::path binaryFile = file;
+    if (file.extension() != TrajectoryFile::s_extension) {
+        const auto converted = TrajectoryFile::getPath(file);
+        std::error_code error;
+        if (std::filesystem::exists(converted) && std::filesystem::last_write_time(converted, error) >= std::filesystem::last_write_time(file, error))
+            binaryFile = converted;
+    }
+
+    if (binaryFile.extension() == TrajectoryFile::s_extension) {
+        std::vector<TrajectoryJoint> fileJoints;
+        auto sampler = TrajectoryFile::read(binaryFile, fileJoints);
+        if (sampler && sampler->numJoints() != numJoints()) {
+            LOG_ERROR << "Trajectory has " << sampler->numJoints() << " joints, robot has " << numJoints() << ": " << binaryFile;
+            sampler = nullptr;
+        }
+
+        if (sampler) {
+            const auto joints = getTrajectoryJoints();
+            for (size_t i = 0; i < numJoints(); ++i)
+                if (fileJoints[i].name != joints[i].name)
+                    LOG_WARN << "Trajectory joint " << fileJoints[i].name << " drives " << joints[i].name;
+
+            setTrajectory(sampler, binaryFile);
+            return;
         }
-        traj.jointValues.push_back(jointValues);
-        traj.times.push_back(std::stof(parts[numJoints()]));
+
+        // a converted file of an older version or another robot is replaced by parsing the text again
+        if (binaryFile == file)
+            return;
+        LOG_WARN << "Converted trajectory is unusable, parsing the text again: " << file;
     }
-    m_controlData.trajectory = traj;
 
-    LOG_INFO << "Successfully loaded trajectory file: " << file;
+    // text is converted in the background, streamTrajectory() picks up the result
+    m_trajectoryFile = file;
+    m_trajectoryProgress = 0.0f;
+    m_trajectoryLoad = std::async(std::launch::async, [this, file, joints = getTrajectoryJoints()]() -> std::shared_ptr<const TrajectorySampler> {
+        return TrajectoryFile::convert(file, joints, &m_trajectoryProgress);
+    });
 }
 
-bool Robot::setupLink(const std::string& name, const std::filesystem::path& meshDir, const XmlNode& linkNode)
+void Robot::forwardKinematics(const std::span<const float> jointValues, const size_t numConfigs, const std::span<glm::mat4> t_link_world) const
 {
-    // extract node with visual data
-    std::optional<XmlNode> visualNode;
-    for (const auto& child : linkNode.children) {
-        if (child.tag == "visual")
-            visualNode = child;
-        else if (!visualNode && child.tag == "collision")
-            visualNode = child;
-    }
-    if (!visualNode) {
-        LOG_WARN << "Visual node missing: " << name;
-        return true;
+    m_kinematics.evaluate(jointValues, numConfigs, m_model, t_link_world);
+}
+
+void Robot::streamMeshes()
+{
+    // failed imports leave their mesh empty
+    std::erase_if(m_pendingMeshes, [](const std::shared_ptr<Mesh>& mesh) { return mesh->upload(); });
+
+    if (m_writeCache && !isLoading()) {
+        m_cacheWritten = writeCache();
+        m_writeCache = false;
     }
+}
 
-    // extract node with transformation data and node with geometry data
-    std::optional<XmlNode> originNode;
-    std::optional<XmlNode> geometryNode;
-    for (const auto& child : visualNode->children) {
-        if (child.tag == "origin")
-            originNode = child;
-        else if (child.tag == "geometry")
-            geometryNode = child;
-            
-        if (originNode && geometryNode)
-            break;
+void Robot::waitForMeshes()
+{
+    for (const auto& mesh : m_pendingMeshes)
+        mesh->getAsset()->wait();
+
+    while (isLoading()) {
+        streamMeshes();
+        Renderer::resetUploadBudget();
     }
+}
 
-    // ------------- Transformation
+void Robot::streamTrajectory()
+{
+    if (m_trajectoryPlotsBuild.valid() && m_trajectoryPlotsBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        m_trajectoryPlots = m_trajectoryPlotsBuild.get();
 
-    glm::mat4 t_mesh_world(1.0f);
-    if (originNode) {
-        // get translation
-        auto it = originNode->attributes.find("xyz");
-        glm::vec3 p_mesh_world(0.0f);
-        if (it != originNode->attributes.cend() && it->second.index() == 2)
-            p_mesh_world = 1000.0f*strToVec3(std::get<std::string>(it->second));
-        else
-            LOG_WARN << "No xyz specified: " << name;
+    if (!m_trajectoryLoad.valid() || m_trajectoryLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
 
-        // get rotation
-        it = originNode->attributes.find("rpy");
-        glm::vec3 r_mesh_world(0.0f);
-        if (it != originNode->attributes.cend() && it->second.index() == 2)
-            r_mesh_world = strToVec3(std::get<std::string>(it->second));
-        else
-            LOG_WARN << "No rpy specified: " << name;
+    const auto sampler = m_trajectoryLoad.get();
+    if (!sampler)
+        return;
 
-        t_mesh_world = eulerXYZ(r_mesh_world);
-        setMat4Translation(t_mesh_world, p_mesh_world);
-    }
-    else
-        LOG_WARN << "Origin node missing: " << name;
+    setTrajectory(sampler, m_trajectoryFile);
+}
 
-    // ------------- Mesh
+bool Robot::waitForCache()
+{
+    return m_cacheWritten.valid() && m_cacheWritten.get();
+}
 
-    // check geometry data
-    if (!geometryNode) {
-        LOG_WARN << "Geometry node missing: " << name;
-        return false;
+std::future<bool> Robot::writeCache() const
+{
+    RobotCache cache;
+    cache.name = m_name;
+
+    // links showing the same asset share one geometry entry
+    std::unordered_map<const MeshAsset*, uint32_t> meshIndices;
+    for (const auto&[name, link] : m_links) {
+        uint32_t mesh = RobotCache::s_noMesh;
+        if (const auto& asset = link->mesh->getAsset(); asset && asset->getGeometry()) {
+            const auto [it, inserted] = meshIndices.try_emplace(asset.get(), static_cast<uint32_t>(cache.meshes.size()));
+            if (inserted)
+                cache.meshes.emplace_back(asset->getFile().string(), asset->getHash(), asset->getGeometry());
+            mesh = it->second;
+        }
+        cache.links.emplace_back(name, mesh, link->t_mesh_link);
     }
+    for (const auto& joint : m_joints)
+        cache.joints.emplace_back(joint->name, joint->parent->name, joint->child->name, joint->parentToChild, joint->rotationAxis, joint->limits);
 
-    // extract node with geometry data
-    std::optional<XmlNode> meshNode;
-    for (const auto& child : geometryNode->children) 
-        if (child.tag == "mesh") {
-            meshNode = child;
-            break;
+    // geometry is immutable once set, the snapshot only shares it with the writer
+    return ThreadPool::get().submit([cache = std::move(cache), file = m_cacheFile, hash = m_cacheHash]() {
+        return cache.write(file, hash);
+    });
+}
+
+bool Robot::setupFromCache(const RobotCache& cache, const bool shareMeshes)
+{
+    m_name = cache.name;
+    LOG_INFO << "adding Robot from cache: " << m_name;
+
+    std::vector<std::shared_ptr<MeshAsset>> assets;
+    for (const auto& [file, hash, geometry] : cache.meshes)
+        assets.push_back(shareMeshes ? MeshLibrary::add(file, hash, geometry) : std::make_shared<MeshAsset>(geometry, file, hash));
+
+    for (const auto& link : cache.links) {
+        const auto mesh = std::make_shared<Mesh>();
+        if (link.mesh != RobotCache::s_noMesh) {
+            mesh->setAsset(assets[link.mesh]);
+            m_pendingMeshes.push_back(mesh);
+            m_numMeshes++;
         }
-    if (!meshNode) {
-        LOG_ERROR << "Mesh node missing: " << name;
-        return false;
+        addLink(link.name, mesh, link.t_mesh_link);
     }
 
-    // get mesh file name
-    auto it = meshNode->attributes.find("filename");
-    if (it == meshNode->attributes.cend() || it->second.index() != 2) {
-        LOG_ERROR << "No mesh-file specified: " << name;
-        return false;
-    }
+    for (const auto& joint : cache.joints)
+        setupJoint(joint);
+    buildKinematics();
+
+    m_controlData.drawFrames = true;
+    m_controlData.drawBoundingBoxes = false;
+    return true;
+}
+
+bool Robot::setupLink(const UrdfLink& link, const std::filesystem::path& meshDir, const std::unordered_map<std::string, uint64_t>& meshHashes, const bool shareMeshes)
+{
+    const auto& [name, filename, t_mesh_world] = link;
 
     // check mesh file
-    const std::filesystem::path meshFile = meshDir.string() + '/' + std::get<std::string>(it->second);
+    const std::filesystem::path meshFile = meshDir.string() + '/' + filename;
     if (aiIsExtensionSupported(meshFile.extension().c_str()) == AI_FALSE) {
         LOG_ERROR << "Invalid mesh-file: " << name;
         return false;
     }      
 
-    // create entity with mesh data
-    Assimp::Importer importer;
-    importer.SetPropertyInteger(AI_CONFIG_IMPORT_COLLADA_IGNORE_UP_DIRECTION, 1);
-    const aiScene* meshSource = importer.ReadFile(meshFile.c_str(), aiProcessPreset_TargetRealtime_Fast);
-    const auto mesh = std::make_shared<Mesh>(meshSource, t_mesh_world);
+    // create entity, mesh data is decoded on the pool and uploaded in update(),
+    // the visual origin stays out of the geometry so other links and robots can share it
+    // the cache key already hashed the mesh directory, only files outside of it are read here
+    const auto hash = meshHashes.find(std::filesystem::path(filename).lexically_normal().generic_string());
+    const auto mesh = std::make_shared<Mesh>();
+    mesh->setAsset(MeshLibrary::load(meshFile, hash != meshHashes.end() ? hash->second : MeshLibrary::computeHash(meshFile), shareMeshes));
+    m_pendingMeshes.push_back(mesh);
+    m_numMeshes++;
+
+    addLink(name, mesh, t_mesh_world);
+    return true;
+}
+
+void Robot::addLink(const std::string& name, const std::shared_ptr<Mesh>& mesh, const glm::mat4& t_mesh_link)
+{
     addEntity(name, mesh);
-    importer.FreeScene();
 
     // create Frame
     const auto frame = std::make_shared<Frame>();
@@ -277,165 +330,132 @@ bool Robot::setupLink(const std::string& name, const std::filesystem::path& mesh
 
     // add link
     LOG_INFO << "adding link: " << name;
-    m_links.emplace(name, std::make_shared<LinkData>(name, mesh, frame));
-
-    return true;
+    const auto link = std::make_shared<LinkData>(name, mesh, frame, static_cast<uint32_t>(m_linkList.size()), t_mesh_link);
+    m_links.emplace(name, link);
+    m_linkList.push_back(link);
 }
 
-bool Robot::setupJoint(const std::string& name, const XmlNode& linkNode)
+void Robot::setupJoint(const UrdfJoint& joint)
 {
-    // extract nodes with transformation data, parent, child and limit
-    std::optional<XmlNode> originNode, parentNode, childNode, axisNode, limitNode;
-    for (const auto& child : linkNode.children) {
-        if (child.tag == "origin")
-            originNode = child;
-        else if (child.tag == "parent")
-            parentNode = child;
-        else if (child.tag == "child")
-            childNode = child;
-        else if (child.tag == "axis")
-            axisNode = child;
-        else if (child.tag == "limit")
-            limitNode = child;
+    const auto parent = m_links.find(joint.parent);
+    if (parent == m_links.end()) {
+        LOG_WARN << "No valid parent specified: " << joint.name;
+        return;
     }
 
-    // ------------- Transformation
-
-    if (!originNode) {
-        LOG_ERROR << "Origin node missing: " << name;
-        return false;
-    }
-    
-    // get translation
-    auto it = originNode->attributes.find("xyz");
-    glm::vec3 p_child_parent(0.0f);
-    if (it != originNode->attributes.cend() && it->second.index() == 2)
-        p_child_parent = 1000.0f*strToVec3(std::get<std::string>(it->second));
-    else
-        LOG_WARN << "No xyz specified: " << name;
-
-    // get rotation
-    it = originNode->attributes.find("rpy");
-    glm::vec3 r_child_parent(0.0f);
-    if (it != originNode->attributes.cend() && it->second.index() == 2)
-        r_child_parent = strToVec3(std::get<std::string>(it->second));
-    else
-        LOG_WARN << "No rpy specified: " << name;
-
-    glm::mat4 t_child_parent = eulerXYZ(r_child_parent);
-    setMat4Translation(t_child_parent, p_child_parent);
-
-    // ------------- Parent/Child
-
-    // get parent
-    if (!parentNode) {
-        LOG_ERROR << "Parent node missing: " << name;
-        return false;
+    const auto child = m_links.find(joint.child);
+    if (child == m_links.end()) {
+        LOG_WARN << "No valid child specified: " << joint.name;
+        return;
     }
 
-    it = parentNode->attributes.find("link");
-    std::shared_ptr<LinkData> parent = nullptr;
-    if (it != parentNode->attributes.cend() && it->second.index() == 2) {
-        const auto parentName = std::get<std::string>(it->second);
-        if (const auto p = m_links.find(parentName); p != m_links.end())
-            parent = p->second;
-    }
+    // add joint
+    LOG_INFO << "adding joint: " << joint.name;
+    m_joints.push_back(std::make_shared<JointData>(joint.name, parent->second, child->second, joint.parentToChild, joint.rotationAxis, joint.limits));
+    m_controlData.jointValues.push_back((joint.limits.first+joint.limits.second)/2.0f);
+}
 
-    if (!parent) {
-        LOG_WARN << "No valid parent specified: " << name;
-        return true;
-    }
+void Robot::addEntity(const std::string& name, const std::shared_ptr<Entity>& entity) 
+{ 
+    assert(m_entities.find(name) == m_entities.end() && "Entity already exists");
+    m_entities.emplace(name, entity); 
+}
 
-    // get child
-    if (!childNode) {
-        LOG_ERROR << "Parent node missing: " << name;
-        return false;
-    }
+std::vector<TrajectoryJoint> Robot::getTrajectoryJoints() const
+{
+    std::vector<TrajectoryJoint> joints;
+    for (const auto& joint : m_joints)
+        joints.emplace_back(joint->name, "rad");
+    return joints;
+}
 
-    it = childNode->attributes.find("link");
-    std::shared_ptr<LinkData> child = nullptr;
-    if (it != childNode->attributes.cend() && it->second.index() == 2) {
-        const auto childName = std::get<std::string>(it->second);
-        if (const auto p = m_links.find(childName); p != m_links.end())
-            child = p->second;
-    }
+void Robot::setTrajectory(const std::shared_ptr<const TrajectorySampler>& sampler, const std::filesystem::path& file)
+{
+    Trajectory traj;
+    traj.sampler = sampler;
+    traj.currentTime = sampler->startTime();
 
-    if (!child) {
-        LOG_WARN << "No valid child specified: " << name;
-        return true;
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_controlData.trajectory = std::move(traj);
     }
 
-    // ------------- Axis
-
-    // get axis
-    glm::vec3 axis(1.0f, 0.0f, 0.0f);
-    if (axisNode) {
-        it = axisNode->attributes.find("xyz");
-        if (it != limitNode->attributes.cend() && it->second.index() == 2)
-            axis = glm::normalize(strToVec3(std::get<std::string>(it->second)));
-        else {
-            LOG_ERROR << "Axis xyz missing: " << name;
-            return false;
+    // velocities are the spline slopes, no differentiation of noisy samples
+    m_trajectoryPlots.reset();
+    m_trajectoryPlotsBuild = ThreadPool::get().submit([sampler]() -> std::shared_ptr<const TrajectoryPlots> {
+        auto plots = std::make_shared<TrajectoryPlots>();
+        plots->sampler = sampler;
+        plots->positions.resize(sampler->numJoints());
+        plots->velocities.resize(sampler->numJoints());
+        for (size_t j = 0; j < sampler->numJoints(); ++j) {
+            plots->positions[j].build(sampler->getValues(j), sampler->numSamples(), sampler->seriesStride());
+            plots->velocities[j].build(sampler->getSlopes(j), sampler->numSamples(), sampler->seriesStride());
         }
-    }
-    else 
-        LOG_WARN << "Axis node missing: " << name;
+        return plots;
+    });
 
-    // ------------- Limits
+    LOG_INFO << "Successfully loaded trajectory file: " << file << " (" << sampler->numSamples() << " samples)";
+}
 
-    // get limits
-    std::pair<float, float> limits(0.0f, 0.0f);
-    if (limitNode) {
-        it = limitNode->attributes.find("lower");
-        if (it != limitNode->attributes.cend() && it->second.index() == 1)
-            limits.first = std::get<float>(it->second);
-        else
-            LOG_WARN << "No lower limit specified: " << name;
-            
-        it = limitNode->attributes.find("upper");
-        if (it != limitNode->attributes.cend() && it->second.index() == 1)
-            limits.second = std::get<float>(it->second);
-        else
-            LOG_WARN << "No upper limit specified: " << name;
-    }
-    else
-        LOG_WARN << "No limits specified: " << name;
+void Robot::buildKinematics()
+{
+    std::vector<KinematicJoint> joints;
+    joints.reserve(m_joints.size());
+    for (const auto& joint : m_joints)
+        joints.emplace_back(joint->parent->index, joint->child->index, joint->parentToChild, joint->rotationAxis);
 
-    // add joint
-    LOG_INFO << "adding joint: " << name;
-    m_joints.push_back(std::make_shared<JointData>(name, parent, child, t_child_parent, axis, limits));
-    m_controlData.jointValues.push_back((limits.first+limits.second)/2.0f);
+    m_kinematics.build(m_linkList.size(), joints);
 
-    return true;
+    // every snapshot starts at the initial pose, the simulation thread never allocates
+    RobotSnapshot initial(0.0, std::vector<glm::mat4>(m_linkList.size()));
+    m_kinematics.evaluate(m_controlData.jointValues, glm::mat4(1.0f), initial.t_link_base);
+    m_snapshots.forEach([&initial](RobotSnapshot& snapshot) { snapshot = initial; });
+    m_previousSnapshot = initial;
+
+    m_stepJointValues = m_controlData.jointValues;
+    m_linkWorld.assign(m_linkList.size(), glm::mat4(1.0f));
 }
 
-void Robot::addEntity(const std::string& name, const std::shared_ptr<Entity>& entity) 
-{ 
-    assert(m_entities.find(name) == m_entities.end() && "Entity already exists");
-    m_entities.emplace(name, entity); 
+void Robot::advanceTrajectory(const Timestep dt)
+{
+    if (!m_controlData.trajectory || !m_controlData.trajectory->active)
+        return;
+
+    auto& [active, currentTime, sampler, cursor] = *m_controlData.trajectory;
+    if (currentTime >= sampler->endTime()) {
+        active = false;
+        return;
+    }
+
+    currentTime += dt;
+    sampler->sample(currentTime, cursor, m_controlData.jointValues);
 }
 
-glm::mat4 Robot::forwardTransform()
+void Robot::forwardTransform(const double time)
 {
-    glm::mat4 t_child_world(1.0f);
-    for (size_t i = 0; i < m_joints.size(); ++i) {
-        auto& joint = m_joints[i];
-
-        auto& parentLink = joint->parent;
-        auto& childLink = joint->child;
-        
-        if (i == 0)
-            parentLink->mesh->setTransformation(m_model);
-
-        const auto t_parent_world = parentLink->mesh->getModel();
-        t_child_world = joint->parentToChild * t_parent_world;
-        t_child_world = glm::mat4(angleAxisF(m_controlData.jointValues[i], joint->rotationAxis)) * t_child_world;
-          
-        childLink->mesh->setTransformation(t_child_world);
-        parentLink->frame->setTransformation(t_child_world);
-        parentLink->frame->scale({400.0f, 400.0f, 400.0f});
-        parentLink->frame->setVisible(m_controlData.drawFrames);
+    const auto& previous = m_previousSnapshot;
+    const auto& current = m_snapshots.read();
+    const double span = current.time - previous.time;
+    const float alpha = span > 0.0 ? static_cast<float>(std::clamp((time - previous.time)/span, 0.0, 1.0)) : 1.0f;
+
+    // the base transform is applied here, moving the robot does not wait for the simulation
+    for (size_t i = 0; i < m_linkList.size(); ++i) {
+        m_linkWorld[i] = interpolateMat4(previous.t_link_base[i], current.t_link_base[i], alpha) * m_model;
+        m_linkList[i]->mesh->setTransformation(m_linkList[i]->t_mesh_link * m_linkWorld[i]);
+    }
+
+    // frames of the parent links sit at the joints
+    const auto& parents = m_kinematics.getParents();
+    const auto& children = m_kinematics.getChildren();
+    for (size_t i = 0; i < m_kinematics.numJoints(); ++i) {
+        const auto& frame = m_linkList[parents[i]]->frame;
+        frame->setTransformation(m_linkWorld[children[i]]);
+        frame->scale({400.0f, 400.0f, 400.0f});
+        frame->setVisible(m_controlData.drawFrames);
     }
 
-    return t_child_world;
+    m_linksBB = BoundingBox();
+    for (const auto&[name, entity] : m_entities)
+        if (entity->isVisible())
+            m_linksBB.grow(entity->getBoundingBox());
 }
\ No newline at end of file
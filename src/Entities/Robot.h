@@ -3,19 +3,29 @@
 #include "Renderer/Camera.h"
 
 #include "Entity.h"
-
-#include "Xml/XmlParser.h"
+#include "Mesh.h"
 
 #include "Util/EdgeDetector.h"
+#include "Util/KinematicModel.h"
+#include "Util/MinMaxPyramid.h"
+#include "Util/TrajectorySampler.h"
+#include "Util/TripleBuffer.h"
 
-class Mesh;
 class Frame;
+class RobotCache;
+
+struct TrajectoryJoint;
+
+struct UrdfLink;
+struct UrdfJoint;
 
 struct LinkData
 {
     std::string name;
     std::shared_ptr<Mesh> mesh;
     std::shared_ptr<Frame> frame;
+    uint32_t index;
+    glm::mat4 t_mesh_link;
 };
 
 struct JointData
@@ -31,10 +41,19 @@ struct JointData
 struct Trajectory
 {
     bool active = false;
-    float currentTime = 0.0f;
-    size_t currentIndex = 0;
-    std::vector<std::vector<float>> jointValues;
-    std::vector<float> times;
+    double currentTime = 0.0;
+    // immutable, may be shared with a background writer
+    std::shared_ptr<const TrajectorySampler> sampler;
+    TrajectorySampler::Cursor cursor;
+};
+
+// per joint envelopes of a trajectory, built once in the background
+struct TrajectoryPlots
+{
+    // the pyramids read its samples
+    std::shared_ptr<const TrajectorySampler> sampler;
+    std::vector<MinMaxPyramid> positions;
+    std::vector<MinMaxPyramid> velocities;
 };
 
 struct RobotControlData
@@ -46,38 +65,86 @@ struct RobotControlData
     std::optional<Trajectory> trajectory;
 };
 
+// link transforms relative to the robot base after one simulation step
+struct RobotSnapshot
+{
+    double time;
+    std::vector<glm::mat4> t_link_base;
+};
+
 class Robot : public Entity
 {
 public:
     Robot();
     ~Robot();
 
-    bool setup(const std::filesystem::path& sourceDir);
+    // shared meshes reuse the geometry of any robot already showing the same mesh files
+    bool setup(const std::filesystem::path& sourceDir, const bool useCache = true, const bool shareMeshes = true);
+
+    // simulation thread, advances the trajectory and publishes the link transforms
+    void step(const double time, const Timestep dt);
 
-    void update(const Timestep dt);
+    // render thread, places the link entities between the last two snapshots
+    void update();
     
     virtual void draw(const Camera& camera) override;
-    virtual void updateTriangulationData() override;
+
+    // union of the link entities, follows the last forward transform
+    inline virtual const BoundingBox& getBoundingBox() const override { return m_linksBB; }
 
     virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const;
 
+    // binary trajectories are mapped right away, text is parsed in the background
     void loadTrajectory(const std::filesystem::path& file);
+    void streamTrajectory();
+    inline bool isLoadingTrajectory() const { return m_trajectoryLoad.valid(); }
+    inline float getTrajectoryProgress() const { return m_trajectoryProgress; }
+
+    // null until built for the current trajectory
+    inline const std::shared_ptr<const TrajectoryPlots>& getTrajectoryPlots() const { return m_trajectoryPlots; }
+
+    // no side effects on the entities, jointValues holds numConfigs values per joint
+    void forwardKinematics(const std::span<const float> jointValues, const size_t numConfigs, const std::span<glm::mat4> t_link_world) const;
+
+    void streamMeshes();
+    void waitForMeshes();
+    bool waitForCache();
+    inline bool isLoading() const { return !m_pendingMeshes.empty(); }
+    inline size_t numMeshes() const { return m_numMeshes; }
+    inline size_t numMeshesLoaded() const { return m_numMeshes - m_pendingMeshes.size(); }
 
     inline const std::string& getName() const { return m_name; }
+    inline const std::filesystem::path& getSourceDir() const { return m_sourceDir; }
 
+    // joint values and trajectory are shared with the simulation thread, hold the mutex while changing them
     inline RobotControlData& getControlData() { return m_controlData; }
+    inline std::mutex& getControlMutex() { return m_controlMutex; }
     inline const std::unordered_map<std::string, std::shared_ptr<LinkData>>& getLinks() const { return m_links; }
     inline const std::vector<std::shared_ptr<JointData>>& getJoints() const { return m_joints; }
     inline size_t numLinks() const { return m_links.size(); }
     inline size_t numJoints() const { return m_joints.size(); }
+    inline const KinematicModel& getKinematics() const { return m_kinematics; }
+
+protected:
+    virtual void updateTriangulationData() override { }
 
 private:
-    bool setupLink(const std::string& name, const std::filesystem::path& meshDir, const XmlNode& linkNode);
-    bool setupJoint(const std::string& name, const XmlNode& jointNode);
+    bool setupFromCache(const RobotCache& cache, const bool shareMeshes);
+    bool setupLink(const UrdfLink& link, const std::filesystem::path& meshDir, const std::unordered_map<std::string, uint64_t>& meshHashes, const bool shareMeshes);
+    void setupJoint(const UrdfJoint& joint);
+
+    std::future<bool> writeCache() const;
 
+    void addLink(const std::string& name, const std::shared_ptr<Mesh>& mesh, const glm::mat4& t_mesh_link);
     void addEntity(const std::string& name, const std::shared_ptr<Entity>& entity);
 
-    glm::mat4 forwardTransform();
+    std::vector<TrajectoryJoint> getTrajectoryJoints() const;
+    void setTrajectory(const std::shared_ptr<const TrajectorySampler>& sampler, const std::filesystem::path& file);
+
+    void buildKinematics();
+
+    void advanceTrajectory(const Timestep dt);
+    void forwardTransform(const double time);
 
     std::string m_name;
     std::unordered_map<std::string, std::shared_ptr<Entity>> m_entities;
@@ -85,6 +152,37 @@ private:
     std::unordered_map<std::string, std::shared_ptr<LinkData>> m_links;
     std::vector<std::shared_ptr<JointData>> m_joints;
 
+    // links by index, FK results are written back to the link entities
+    std::vector<std::shared_ptr<LinkData>> m_linkList;
+    KinematicModel m_kinematics;
+
     RobotControlData m_controlData;
+    std::mutex m_controlMutex;
+    BoundingBox m_linksBB;
+
+    // written by the simulation thread only
+    std::vector<float> m_stepJointValues;
+    TripleBuffer<RobotSnapshot> m_snapshots;
+
+    // render thread only
+    RobotSnapshot m_previousSnapshot;
+    std::vector<glm::mat4> m_linkWorld;
+
+    std::vector<std::shared_ptr<Mesh>> m_pendingMeshes;
+    size_t m_numMeshes = 0;
+
+    std::filesystem::path m_sourceDir;
+    std::filesystem::path m_cacheFile;
+    uint64_t m_cacheHash = 0;
+    bool m_writeCache = false;
+    std::future<bool> m_cacheWritten;
+
+    // the load is joined before the progress it writes is destroyed
+    std::filesystem::path m_trajectoryFile;
+    std::atomic<float> m_trajectoryProgress = 0.0f;
+    std::future<std::shared_ptr<const TrajectorySampler>> m_trajectoryLoad;
+
+    std::shared_ptr<const TrajectoryPlots> m_trajectoryPlots;
+    std::future<std::shared_ptr<const TrajectoryPlots>> m_trajectoryPlotsBuild;
 
 };
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "pch.h"
+
+#include "RobotCache.h"
+
+#include "Util/MappedFile.h"
+#include "Util/util.h"
+#include "Util/Log.h"
+
+struct CacheHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t hash;
+    uint64_t size;
+};
+
+static constexpr std::array<char, 8> s_magic = { 'R', 'V', 'C', 'A', 'C', 'H', 'E', '\0' };
+
+// arrays start 8 byte aligned, the geometry uses them in place and keeps the mapping open
+static constexpr size_t s_alignment = 8;
+
+class CacheWriter
+{
+public:
+    CacheWriter(std::ofstream& out) : m_out(out), m_offset(0) {}
+
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void writeArray(const std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<uint64_t>(values.size());
+        pad();
+        writeBytes(values.data(), values.size()*sizeof(T));
+    }
+
+    void writeString(const std::string& str)
+    {
+        write<uint32_t>(static_cast<uint32_t>(str.size()));
+        writeBytes(str.data(), str.size());
+    }
+
+    inline size_t offset() const { return m_offset; }
+
+private:
+    void writeBytes(const void* data, const size_t size)
+    {
+        m_out.write(static_cast<const char*>(data), size);
+        m_offset += size;
+    }
+
+    void pad()
+    {
+        static constexpr std::array<char, s_alignment> zeros{};
+        writeBytes(zeros.data(), (s_alignment - m_offset % s_alignment) % s_alignment);
+    }
+
+    std::ofstream& m_out;
+    size_t m_offset;
+};
+
+class CacheReader
+{
+public:
+    CacheReader(const char* data, const size_t size, const size_t offset) : m_data(data), m_size(size), m_offset(offset) {}
+
+    template<typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return readBytes(&value, sizeof(T));
+    }
+
+    // a view into the data, nothing is copied
+    template<typename T>
+    bool readArray(std::span<const T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= s_alignment);
+        uint64_t count;
+        if (!read(count))
+            return false;
+
+        m_offset += (s_alignment - m_offset % s_alignment) % s_alignment;
+        if (count > (m_size - std::min(m_offset, m_size)) / sizeof(T))
+            return false;
+
+        values = std::span(reinterpret_cast<const T*>(m_data + m_offset), count);
+        m_offset += count*sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string& str)
+    {
+        uint32_t size;
+        if (!read(size) || size > m_size - std::min(m_offset, m_size))
+            return false;
+
+        str.assign(m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+private:
+    bool readBytes(void* data, const size_t size)
+    {
+        if (m_offset + size > m_size)
+            return false;
+
+        std::memcpy(data, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    const char* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+std::filesystem::path RobotCache::getPath(const std::filesystem::path& sourceDir)
+{
+    std::filesystem::path dir = sourceDir.lexically_normal();
+    if (!dir.has_filename())
+        dir = dir.parent_path();
+
+    return dir.parent_path() / (dir.filename().string() + ".rvcache");
+}
+
+uint64_t RobotCache::computeHash(const std::filesystem::path& urdfFile, const std::filesystem::path& meshDir, std::unordered_map<std::string, uint64_t>& meshHashes)
+{
+    uint64_t hash = hashBytes(&s_version, sizeof(s_version));
+    const MappedFile urdf(urdfFile);
+    const uint64_t size = urdf.size();
+    hash = hashBytes(&size, sizeof(size), hash);
+    if (urdf.isOpen())
+        hash = hashBytes(urdf.data(), urdf.size(), hash);
+
+    // meshes are only known after parsing, so every file in the mesh directory is part of the key
+    std::vector<std::filesystem::path> meshFiles;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(meshDir))
+        if (entry.is_regular_file())
+            meshFiles.push_back(entry.path());
+    std::sort(meshFiles.begin(), meshFiles.end());
+
+    // every mesh is read once, the library looks its assets up by the same hashes
+    for (const auto& file : meshFiles) {
+        const std::string relative = std::filesystem::relative(file, meshDir).generic_string();
+        const uint64_t meshHash = MeshLibrary::computeHash(file);
+        meshHashes[relative] = meshHash;
+        hash = hashBytes(relative.data(), relative.size(), hash);
+        hash = hashBytes(&meshHash, sizeof(meshHash), hash);
+    }
+
+    return hash;
+}
+
+std::optional<RobotCache> RobotCache::read(const std::filesystem::path& file, const uint64_t hash)
+{
+    if (!std::filesystem::exists(file))
+        return std::nullopt;
+
+    // shared by all geometries read from it, the writer replaces the file instead of changing it
+    const auto mapped = std::make_shared<const MappedFile>(file);
+    CacheHeader header;
+    if (!mapped->isOpen() || mapped->size() < sizeof(CacheHeader)) {
+        LOG_WARN << "Invalid robot cache: " << file;
+        return std::nullopt;
+    }
+    std::memcpy(&header, mapped->data(), sizeof(CacheHeader));
+
+    if (header.magic != s_magic || header.size != mapped->size()) {
+        LOG_WARN << "Invalid robot cache: " << file;
+        return std::nullopt;
+    }
+    if (header.version != s_version || header.hash != hash) {
+        LOG_INFO << "Robot cache outdated: " << file;
+        return std::nullopt;
+    }
+
+    RobotCache cache;
+    CacheReader reader(mapped->data(), mapped->size(), sizeof(CacheHeader));
+    const auto readGeometry = [&reader, &mapped](MeshGeometry& geometry) {
+        uint64_t numMeshes;
+        if (!reader.read(numMeshes))
+            return false;
+
+        geometry.meshData.resize(numMeshes);
+        for (auto& meshData : geometry.meshData) {
+            if (!reader.readArray(meshData.vertices) || !reader.readArray(meshData.indices) || !reader.readArray(meshData.meshlets) ||
+                !reader.read(meshData.bb.min) || !reader.read(meshData.bb.max) || !reader.read(meshData.color))
+                return false;
+
+            uint64_t numLods;
+            if (!reader.read(numLods) || numLods > mapped->size())
+                return false;
+
+            meshData.lods.resize(numLods);
+            for (auto& lod : meshData.lods)
+                if (!reader.readArray(lod.indices) || !reader.read(lod.error))
+                    return false;
+        }
+
+        std::span<const BvhNode> nodes;
+        std::span<const std::array<glm::vec3, 3>> triangles;
+        if (!reader.read(geometry.bb.min) || !reader.read(geometry.bb.max) || !reader.readArray(nodes) || !reader.readArray(triangles))
+            return false;
+
+        geometry.bvh.view(nodes, triangles);
+        geometry.storage = mapped;
+        return true;
+    };
+
+    const auto readContent = [&]() {
+        uint32_t numMeshes, numLinks, numJoints;
+        if (!reader.readString(cache.name) || !reader.read(numMeshes) || !reader.read(numLinks) || !reader.read(numJoints))
+            return false;
+        if (numMeshes > mapped->size() || numLinks > mapped->size() || numJoints > mapped->size())
+            return false;
+
+        cache.meshes.resize(numMeshes);
+        for (auto& mesh : cache.meshes) {
+            auto geometry = std::make_shared<MeshGeometry>();
+            if (!reader.readString(mesh.file) || !reader.read(mesh.hash) || !readGeometry(*geometry))
+                return false;
+            mesh.geometry = geometry;
+        }
+
+        cache.links.resize(numLinks);
+        for (auto& link : cache.links)
+            if (!reader.readString(link.name) || !reader.read(link.mesh) || !reader.read(link.t_mesh_link) ||
+                (link.mesh != s_noMesh && link.mesh >= numMeshes))
+                return false;
+
+        cache.joints.resize(numJoints);
+        for (auto& joint : cache.joints)
+            if (!reader.readString(joint.name) || !reader.readString(joint.parent) || !reader.readString(joint.child) ||
+                !reader.read(joint.parentToChild) || !reader.read(joint.rotationAxis) || !reader.read(joint.limits.first) || !reader.read(joint.limits.second))
+                return false;
+
+        return true;
+    };
+
+    if (!readContent()) {
+        LOG_WARN << "Corrupt robot cache: " << file;
+        return std::nullopt;
+    }
+
+    return cache;
+}
+
+bool RobotCache::write(const std::filesystem::path& file, const uint64_t hash) const
+{
+    // write to a temporary file first, a reader never sees a partially written cache
+    const std::filesystem::path tmpFile = file.string() + ".tmp";
+    std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_WARN << "Failed to write robot cache: " << file;
+        return false;
+    }
+
+    CacheHeader header{ s_magic, s_version, 0, hash, 0 };
+    CacheWriter writer(out);
+    writer.write(header);
+
+    writer.writeString(name);
+    writer.write<uint32_t>(static_cast<uint32_t>(meshes.size()));
+    writer.write<uint32_t>(static_cast<uint32_t>(links.size()));
+    writer.write<uint32_t>(static_cast<uint32_t>(joints.size()));
+
+    for (const auto& mesh : meshes) {
+        writer.writeString(mesh.file);
+        writer.write(mesh.hash);
+
+        const auto& geometry = *mesh.geometry;
+        writer.write<uint64_t>(geometry.meshData.size());
+        for (const auto& meshData : geometry.meshData) {
+            writer.writeArray(meshData.vertices);
+            writer.writeArray(meshData.indices);
+            writer.writeArray(meshData.meshlets);
+            writer.write(meshData.bb.min);
+            writer.write(meshData.bb.max);
+            writer.write(meshData.color);
+            writer.write<uint64_t>(meshData.lods.size());
+            for (const auto& lod : meshData.lods) {
+                writer.writeArray(lod.indices);
+                writer.write(lod.error);
+            }
+        }
+        writer.write(geometry.bb.min);
+        writer.write(geometry.bb.max);
+        writer.writeArray(geometry.bvh.getNodes());
+        writer.writeArray(geometry.bvh.getTriangles());
+    }
+
+    for (const auto& link : links) {
+        writer.writeString(link.name);
+        writer.write(link.mesh);
+        writer.write(link.t_mesh_link);
+    }
+
+    for (const auto& joint : joints) {
+        writer.writeString(joint.name);
+        writer.writeString(joint.parent);
+        writer.writeString(joint.child);
+        writer.write(joint.parentToChild);
+        writer.write(joint.rotationAxis);
+        writer.write(joint.limits.first);
+        writer.write(joint.limits.second);
+    }
+
+    header.size = writer.offset();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+    out.close();
+
+    std::error_code error;
+    if (out)
+        std::filesystem::rename(tmpFile, file, error);
+    if (!out || error) {
+        LOG_WARN << "Failed to write robot cache: " << file;
+        std::filesystem::remove(tmpFile, error);
+        return false;
+    }
+
+    LOG_INFO << "Wrote robot cache: " << file << " (" << header.size / 1024 << " KiB)";
+    return true;
+}
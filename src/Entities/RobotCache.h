@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Mesh.h"
+#include "UrdfReader.h"
+
+// geometry is stored once per asset, links refer to it by index
+struct CachedMesh
+{
+    std::string file;
+    uint64_t hash;
+    std::shared_ptr<const MeshGeometry> geometry;
+};
+
+struct CachedLink
+{
+    std::string name;
+    uint32_t mesh;
+    glm::mat4 t_mesh_link;
+};
+
+class RobotCache
+{
+public:
+    static std::filesystem::path getPath(const std::filesystem::path& sourceDir);
+    // meshHashes receives the MeshLibrary hash of every mesh file by its path relative to meshDir
+    static uint64_t computeHash(const std::filesystem::path& urdfFile, const std::filesystem::path& meshDir, std::unordered_map<std::string, uint64_t>& meshHashes);
+
+    static std::optional<RobotCache> read(const std::filesystem::path& file, const uint64_t hash);
+    bool write(const std::filesystem::path& file, const uint64_t hash) const;
+
+    std::string name;
+    std::vector<CachedMesh> meshes;
+    std::vector<CachedLink> links;
+    std::vector<UrdfJoint> joints;
+
+    inline static constexpr uint32_t s_version = 7;
+    inline static constexpr uint32_t s_noMesh = std::numeric_limits<uint32_t>::max();
+};
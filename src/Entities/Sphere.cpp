@@ -7,31 +7,30 @@
 #include "Util/Log.h"
 #include "Util/geometry.h"
 
+std::weak_ptr<VertexArray> Sphere::s_vertexArray;
+
 Sphere::Sphere(const glm::vec4& color)
     : m_color(color)
 {
-    if (ShaderLibrary::exists("FlatColor"))
-        m_shader = ShaderLibrary::get("FlatColor");
-    else
-        m_shader = ShaderLibrary::load("/home/david/Schreibtisch/RoboVis/src/Shaders/FlatColor", "FlatColor");
+    m_shader = ShaderLibrary::get("FlatColor");
 
-    createBuffers();
-}
+    m_localBB = { glm::vec3(-0.5f), glm::vec3(0.5f) };
 
-Sphere::~Sphere()
-{
-    m_vertexArray.release();
+    m_vertexArray = s_vertexArray.lock();
+    if (!m_vertexArray) {
+        m_vertexArray = createBuffers();
+        s_vertexArray = m_vertexArray;
+    }
 }
 
-void Sphere::draw(const Camera& camera)
+Sphere::~Sphere() = default;
+
+void Sphere::draw(const Camera& /*camera*/)
 {
     if (!m_visible)
         return;
 
-    updateMvp(camera);
-
-    m_shader->uploadVec4("u_color", m_color);
-    Renderer::draw(m_shader, m_vertexArray);
+    Renderer::submit(m_shader, *m_vertexArray, glm::transpose(m_model), m_color);
 }
 
 // Constants for the sphere
@@ -88,7 +87,7 @@ static constexpr auto generateSphere()
     return sphereData;
 }
 
-void Sphere::createBuffers()
+std::shared_ptr<VertexArray> Sphere::createBuffers()
 {
     auto sphereData = generateSphere();
 
@@ -98,9 +97,12 @@ void Sphere::createBuffers()
         { ShaderDataType::Float3, "a_position" }
     };
     vertexBuffer->setLayout(layout);
-    m_vertexArray.addVertexBuffer(vertexBuffer);
+
+    std::shared_ptr<VertexArray> vertexArray = std::make_shared<VertexArray>();
+    vertexArray->addVertexBuffer(vertexBuffer);
 
     std::shared_ptr<IndexBuffer> indexBuffer = std::make_shared<IndexBuffer>();
     indexBuffer->allocate(sphereData.second.data(), sphereData.second.size());
-    m_vertexArray.setIndexBuffer(indexBuffer);
+    vertexArray->setIndexBuffer(indexBuffer);
+    return vertexArray;
 }
\ No newline at end of file
@@ -11,14 +11,20 @@ public:
     virtual ~Sphere();
 
     virtual void draw(const Camera& camera) override;
-    virtual void updateTriangulationData() override { }
 
     inline virtual bool rayIntersection(const std::tuple<glm::vec3, glm::vec3>& ray_world, glm::vec3& p_hit_world, float& minDist) const override { return false; }
 
+protected:
+    virtual void updateTriangulationData() override { }
+
 private:   
-    void createBuffers();
+    static std::shared_ptr<VertexArray> createBuffers();
 
     glm::vec4 m_color;
-    VertexArray m_vertexArray;
+
+    // markers share one vertex array, the color goes with the instance
+    std::shared_ptr<VertexArray> m_vertexArray;
+
+    static std::weak_ptr<VertexArray> s_vertexArray;
 
 };
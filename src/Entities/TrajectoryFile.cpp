@@ -0,0 +1,308 @@
+#include "pch.h"
+
+#include "TrajectoryFile.h"
+
+#include "Util/MappedFile.h"
+#include "Util/ThreadPool.h"
+#include "Util/util.h"
+#include "Util/Log.h"
+
+struct TrajectoryHeader
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t numJoints;
+    uint64_t numSamples;
+    uint64_t stride;
+    uint64_t timesOffset;
+    uint64_t valuesOffset;
+    uint64_t coefficientsOffset;
+    uint64_t size;
+};
+
+// fixed size, names longer than that are cut
+struct TrajectoryJointEntry
+{
+    std::array<char, 48> name;
+    std::array<char, 16> unit;
+};
+
+static constexpr std::array<char, 8> s_magic = { 'R', 'V', 'T', 'R', 'A', 'J', '\0', '\0' };
+
+// cache line, columns can be loaded with aligned simd loads
+static constexpr uint64_t s_alignment = 64;
+
+static uint64_t align(const uint64_t offset)
+{
+    return (offset + s_alignment - 1) / s_alignment * s_alignment;
+}
+
+// every offset follows from the counts, the reader checks the stored ones against it
+static TrajectoryHeader layout(const uint32_t numJoints, const uint64_t numSamples)
+{
+    TrajectoryHeader header{ s_magic, TrajectoryFile::s_version, numJoints, numSamples, TrajectorySampler::stride(numJoints), 0, 0, 0, 0 };
+    header.timesOffset = align(sizeof(TrajectoryHeader) + numJoints*sizeof(TrajectoryJointEntry));
+    header.valuesOffset = align(header.timesOffset + numSamples*sizeof(double));
+    header.coefficientsOffset = align(header.valuesOffset + numJoints*numSamples*sizeof(float));
+    header.size = header.coefficientsOffset + TrajectorySampler::numCoefficients(numSamples, numJoints)*sizeof(float);
+    return header;
+}
+
+template<size_t N>
+static void copyString(std::array<char, N>& dst, const std::string& src)
+{
+    dst.fill('\0');
+    std::copy_n(src.begin(), std::min(src.size(), N - 1), dst.begin());
+}
+
+std::shared_ptr<TrajectorySampler> TrajectoryFile::readText(const std::filesystem::path& file, const size_t numJoints, std::atomic<float>* progress)
+{
+    const MappedFile mapped(file);
+    if (!mapped.isOpen()) {
+        LOG_ERROR << "Failed to open trajectory file: " << file;
+        return nullptr;
+    }
+    const std::string_view text(mapped.data(), mapped.size());
+
+    // chunks end after a newline, every line belongs to exactly one chunk
+    std::vector<std::string_view> chunks;
+    for (size_t begin = 0; begin < text.size();) {
+        const size_t newline = text.find('\n', std::min(begin + s_chunkSize, text.size()) - 1);
+        const size_t end = newline == std::string_view::npos ? text.size() : newline + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    auto& pool = ThreadPool::get();
+    const auto parallelFor = [&pool, &chunks](const auto& func) {
+        std::vector<std::future<void>> futures;
+        futures.reserve(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i)
+            futures.push_back(pool.submit([&func, i]() { func(i); }));
+        for (auto& future : futures)
+            future.get();
+    };
+
+    // lines per chunk give every chunk its first line number and its rows in the columns
+    std::vector<size_t> firstLines(chunks.size() + 1, 0);
+    parallelFor([&](const size_t i) {
+        firstLines[i + 1] = std::count(chunks[i].begin(), chunks[i].end(), '\n') + (chunks[i].back() != '\n' ? 1 : 0);
+    });
+    std::partial_sum(firstLines.begin(), firstLines.end(), firstLines.begin());
+    const size_t numLines = firstLines.back();
+
+    // blank and malformed lines leave gaps at the end of their chunk
+    std::vector<double> times(numLines);
+    std::vector<float> values(numLines*numJoints);
+    std::vector<size_t> numRows(chunks.size());
+    std::vector<std::vector<TrajectoryParseError>> errors(chunks.size());
+    std::atomic<size_t> bytesParsed = 0;
+    parallelFor([&](const size_t i) {
+        numRows[i] = parseChunk(chunks[i], firstLines[i], numJoints, times.data(), values.data(), numLines, errors[i]);
+        if (progress)
+            progress->store(s_parseShare*(bytesParsed.fetch_add(chunks[i].size()) + chunks[i].size()) / text.size());
+    });
+
+    size_t numErrors = 0;
+    for (const auto& chunkErrors : errors)
+        for (const auto& [line, message] : chunkErrors)
+            if (numErrors++ < s_maxReportedErrors)
+                LOG_WARN << "Malformed trajectory line " << line << ": " << message;
+    if (numErrors > s_maxReportedErrors)
+        LOG_WARN << "Skipped " << numErrors << " malformed trajectory lines in total: " << file;
+
+    // close the gaps, columns are rewritten from numLines to numSamples rows, sources always lie behind
+    const size_t numSamples = std::accumulate(numRows.begin(), numRows.end(), size_t(0));
+    if (numSamples != numLines) {
+        for (size_t j = 0; j <= numJoints; ++j) {
+            for (size_t i = 0, dst = 0; i < chunks.size(); dst += numRows[i++]) {
+                if (j == 0)
+                    std::copy_n(times.begin() + firstLines[i], numRows[i], times.begin() + dst);
+                else
+                    std::copy_n(values.begin() + (j - 1)*numLines + firstLines[i], numRows[i], values.begin() + (j - 1)*numSamples + dst);
+            }
+            if (progress)
+                progress->store(s_parseShare + s_compactShare*(j + 1) / (numJoints + 1));
+        }
+        times.resize(numSamples);
+        values.resize(numSamples*numJoints);
+    }
+
+    // without gaps the compaction share is skipped, the build takes the rest
+    const auto buildProgress = [progress](const float done) {
+        constexpr float start = s_parseShare + s_compactShare;
+        if (progress)
+            progress->store(start + (1.0f - start)*done);
+    };
+    auto sampler = std::make_shared<TrajectorySampler>();
+    if (!sampler->build(times, values, numJoints, buildProgress)) {
+        LOG_ERROR << "Trajectory file contains no samples: " << file;
+        return nullptr;
+    }
+    if (progress)
+        progress->store(1.0f);
+    return sampler;
+}
+
+size_t TrajectoryFile::parseChunk(const std::string_view chunk, const size_t firstLine, const size_t numJoints, double* times, float* values, const size_t stride, std::vector<TrajectoryParseError>& errors)
+{
+    const auto isDelimiter = [](const char c) { return c == ';' || c == ',' || c == ' ' || c == '\t' || c == '\r'; };
+
+    // a field ends at a delimiter or the end of the line, "1.5x" is no number
+    const auto parseField = [&isDelimiter](const char*& p, const char* end, auto& value) {
+        while (p < end && isDelimiter(*p))
+            ++p;
+        if (p < end && *p == '+')
+            ++p;
+        const auto [ptr, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc() || (ptr < end && !isDelimiter(*ptr)))
+            return false;
+        p = ptr;
+        return true;
+    };
+
+    size_t row = firstLine;
+    size_t line = firstLine;
+    for (const char* p = chunk.data(), *chunkEnd = chunk.data() + chunk.size(); p < chunkEnd; ++line) {
+        const char* end = static_cast<const char*>(std::memchr(p, '\n', chunkEnd - p));
+        end = end ? end : chunkEnd;
+
+        const char* field = p;
+        p = end + 1;
+        if (std::all_of(field, end, isDelimiter))
+            continue;
+
+        // values land in their row right away, a later bad field leaves the row to the next line
+        size_t j = 0;
+        for (float value; j < numJoints && parseField(field, end, value); ++j)
+            values[j*stride + row] = value;
+        if (j < numJoints) {
+            errors.emplace_back(line + 1, "joint value " + std::to_string(j + 1) + " missing or invalid");
+            continue;
+        }
+        if (double time; parseField(field, end, time))
+            times[row++] = time;
+        else
+            errors.emplace_back(line + 1, "time missing or invalid");
+    }
+
+    return row - firstLine;
+}
+
+std::shared_ptr<TrajectorySampler> TrajectoryFile::read(const std::filesystem::path& file, std::vector<TrajectoryJoint>& joints)
+{
+    auto mapped = std::make_shared<MappedFile>(file);
+    if (!mapped->isOpen() || mapped->size() < sizeof(TrajectoryHeader)) {
+        LOG_ERROR << "Invalid trajectory file: " << file;
+        return nullptr;
+    }
+
+    TrajectoryHeader header;
+    std::memcpy(&header, mapped->data(), sizeof(TrajectoryHeader));
+    if (header.magic != s_magic || header.version != s_version) {
+        LOG_ERROR << "Invalid trajectory file: " << file;
+        return nullptr;
+    }
+
+    // counts bounded by the file size first, the layout cannot overflow after that
+    const TrajectoryHeader expected = header.numJoints < mapped->size() && header.numSamples < mapped->size() ? layout(header.numJoints, header.numSamples) : TrajectoryHeader{};
+    if (header.size != mapped->size() || header.stride != expected.stride || header.timesOffset != expected.timesOffset ||
+        header.valuesOffset != expected.valuesOffset || header.coefficientsOffset != expected.coefficientsOffset || header.size != expected.size) {
+        LOG_ERROR << "Corrupt trajectory file: " << file;
+        return nullptr;
+    }
+
+    joints.resize(header.numJoints);
+    for (size_t j = 0; j < joints.size(); ++j) {
+        TrajectoryJointEntry entry;
+        std::memcpy(&entry, mapped->data() + sizeof(TrajectoryHeader) + j*sizeof(TrajectoryJointEntry), sizeof(TrajectoryJointEntry));
+        joints[j].name.assign(entry.name.data(), strnlen(entry.name.data(), entry.name.size()));
+        joints[j].unit.assign(entry.unit.data(), strnlen(entry.unit.data(), entry.unit.size()));
+    }
+
+    // mmap is page aligned, so are the columns
+    const auto times = std::span(reinterpret_cast<const double*>(mapped->data() + header.timesOffset), header.numSamples);
+    const auto coefficients = std::span(reinterpret_cast<const float*>(mapped->data() + header.coefficientsOffset), TrajectorySampler::numCoefficients(header.numSamples, header.numJoints));
+
+    auto sampler = std::make_shared<TrajectorySampler>();
+    if (!sampler->view(times, coefficients, header.numJoints, mapped)) {
+        LOG_ERROR << "Trajectory file contains no samples: " << file;
+        return nullptr;
+    }
+    return sampler;
+}
+
+bool TrajectoryFile::write(const std::filesystem::path& file, const std::vector<TrajectoryJoint>& joints, const TrajectorySampler& sampler)
+{
+    if (sampler.empty() || joints.size() != sampler.numJoints()) {
+        LOG_WARN << "Trajectory does not match its joints: " << file;
+        return false;
+    }
+
+    // write to a temporary file first, a reader never maps a partially written trajectory
+    const std::filesystem::path tmpFile = file.string() + ".tmp";
+    std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_WARN << "Failed to write trajectory file: " << file;
+        return false;
+    }
+
+    const size_t numSamples = sampler.numSamples();
+    const TrajectoryHeader header = layout(static_cast<uint32_t>(joints.size()), numSamples);
+    const auto padTo = [&out](const uint64_t offset) {
+        static constexpr std::array<char, s_alignment> zeros{};
+        const uint64_t pos = out.tellp();
+        out.write(zeros.data(), offset - pos);
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& joint : joints) {
+        TrajectoryJointEntry entry;
+        copyString(entry.name, joint.name);
+        copyString(entry.unit, joint.unit);
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    padTo(header.timesOffset);
+    const auto times = sampler.getTimes();
+    out.write(reinterpret_cast<const char*>(times.data()), times.size_bytes());
+
+    padTo(header.valuesOffset);
+    std::vector<float> column(numSamples);
+    for (size_t j = 0; j < joints.size(); ++j) {
+        for (size_t k = 0; k < numSamples; ++k)
+            column[k] = sampler.value(k, j);
+        out.write(reinterpret_cast<const char*>(column.data()), numSamples*sizeof(float));
+    }
+
+    padTo(header.coefficientsOffset);
+    const auto coefficients = sampler.getCoefficients();
+    out.write(reinterpret_cast<const char*>(coefficients.data()), coefficients.size_bytes());
+
+    out.close();
+
+    std::error_code error;
+    if (out)
+        std::filesystem::rename(tmpFile, file, error);
+    if (!out || error) {
+        LOG_WARN << "Failed to write trajectory file: " << file;
+        std::filesystem::remove(tmpFile, error);
+        return false;
+    }
+
+    LOG_INFO << "Wrote trajectory file: " << file << " (" << numSamples << " samples, " << header.size / (1024*1024) << " MiB)";
+    return true;
+}
+
+std::shared_ptr<TrajectorySampler> TrajectoryFile::convert(const std::filesystem::path& textFile, const std::vector<TrajectoryJoint>& joints, std::atomic<float>* progress)
+{
+    const auto sampler = readText(textFile, joints.size(), progress);
+    if (sampler)
+        ThreadPool::get().submit([sampler, joints, binaryFile = getPath(textFile)]() { return write(binaryFile, joints, *sampler); });
+    return sampler;
+}
+
+std::filesystem::path TrajectoryFile::getPath(const std::filesystem::path& textFile)
+{
+    return std::filesystem::path(textFile).replace_extension(s_extension);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Util/TrajectorySampler.h"
+
+struct TrajectoryJoint
+{
+    std::string name;
+    std::string unit;
+};
+
+struct TrajectoryParseError
+{
+    size_t line;
+    std::string message;
+};
+
+// columnar binary trajectories: header, joint table, time column, one value column per joint and the
+// sampler coefficients, all 64 byte aligned so the mapped file is sampled in place
+class TrajectoryFile
+{
+public:
+    // lines of joint values followed by the time, separated by ';', ',' or spaces, parsed in chunks on the
+    // thread pool, so not from a pool task, malformed lines are reported with their number and skipped
+    static std::shared_ptr<TrajectorySampler> readText(const std::filesystem::path& file, const size_t numJoints, std::atomic<float>* progress = nullptr);
+
+    // constant time, only the header and the joint table are touched
+    static std::shared_ptr<TrajectorySampler> read(const std::filesystem::path& file, std::vector<TrajectoryJoint>& joints);
+    static bool write(const std::filesystem::path& file, const std::vector<TrajectoryJoint>& joints, const TrajectorySampler& sampler);
+
+    // readText() and a write() of the binary next to the text on the thread pool, the sampler is returned without waiting for it
+    static std::shared_ptr<TrajectorySampler> convert(const std::filesystem::path& textFile, const std::vector<TrajectoryJoint>& joints, std::atomic<float>* progress = nullptr);
+
+    // binary file next to a text trajectory
+    static std::filesystem::path getPath(const std::filesystem::path& textFile);
+
+    inline static constexpr uint32_t s_version = 2;
+    inline static constexpr const char* s_extension = ".rvtraj";
+
+private:
+    // rows go to times[firstLine...] and values[joint*stride + firstLine...], returns the number of rows
+    static size_t parseChunk(const std::string_view chunk, const size_t firstLine, const size_t numJoints, double* times, float* values, const size_t stride, std::vector<TrajectoryParseError>& errors);
+
+    inline static constexpr size_t s_chunkSize = 4*1024*1024;
+    inline static constexpr size_t s_maxReportedErrors = 10;
+
+    // shares of the text load progress, the build of the sampler takes the rest
+    inline static constexpr float s_parseShare = 0.6f;
+    inline static constexpr float s_compactShare = 0.1f;
+};
@@ -0,0 +1,336 @@
+#include "pch.h"
+
+#include "UrdfReader.h"
+
+#include "Util/geometry.h"
+#include "Util/Log.h"
+
+static std::optional<float> toFloat(const XmlValue& value)
+{
+    if (const auto f = std::get_if<float>(&value); f != nullptr)
+        return *f;
+    if (const auto i = std::get_if<int>(&value); i != nullptr)
+        return static_cast<float>(*i);
+    return std::nullopt;
+}
+
+UrdfReader::UrdfReader(const std::function<bool(const UrdfLink&)>& onLink)
+    : m_onLink(onLink), m_valid(true), m_numRoots(0), m_hasRobot(false), m_visual(-1)
+{
+}
+
+bool UrdfReader::read(const std::string_view urdf)
+{
+    m_valid = true;
+    m_numRoots = 0;
+    m_hasRobot = false;
+    m_elements.clear();
+    m_name.clear();
+    m_joints.clear();
+
+    XmlSaxParser(urdf).parse(*this);
+
+    if (m_numRoots != 1 || !m_hasRobot) {
+        LOG_ERROR << "Invalid urdf format.";
+        return false;
+    }
+    if (m_name.empty()) {
+        LOG_ERROR << "Invalid robot tag.";
+        return false;
+    }
+
+    return m_valid;
+}
+
+void UrdfReader::startElement(const std::string_view tag)
+{
+    if (m_elements.empty())
+        m_numRoots++;
+
+    const Element element = classify(tag);
+    m_elements.push_back(element);
+
+    switch (element) {
+        case Element::Robot:
+            m_hasRobot = true;
+            break;
+        case Element::Link:
+            m_current.clear();
+            m_visuals = {};
+            m_visual = -1;
+            break;
+        case Element::Joint:
+            m_current.clear();
+            m_joint = UrdfJoint{};
+            m_joint.rotationAxis = glm::vec3(1.0f, 0.0f, 0.0f);
+            m_jointOrigin = {};
+            m_hasParent = m_hasChild = m_hasAxis = m_hasLimit = false;
+            m_axis.reset();
+            m_lower.reset();
+            m_upper.reset();
+            break;
+        case Element::Visual:
+        case Element::Collision: {
+            // the first visual wins, collision geometry is only a fallback
+            const int i = element == Element::Visual ? 0 : 1;
+            m_visual = m_visuals[i].present ? -1 : i;
+            m_visuals[i].present = true;
+            break;
+        }
+        case Element::VisualOrigin:
+            if (m_visual >= 0)
+                m_visuals[m_visual].origin.present = true;
+            break;
+        case Element::Geometry:
+            if (m_visual >= 0)
+                m_visuals[m_visual].hasGeometry = true;
+            break;
+        case Element::Mesh:
+            if (m_visual >= 0)
+                m_visuals[m_visual].hasMesh = true;
+            break;
+        case Element::JointOrigin:
+            m_jointOrigin.present = true;
+            break;
+        case Element::Parent:
+            m_hasParent = true;
+            break;
+        case Element::Child:
+            m_hasChild = true;
+            break;
+        case Element::Axis:
+            m_hasAxis = true;
+            break;
+        case Element::Limit:
+            m_hasLimit = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void UrdfReader::attribute(const std::string_view name, const XmlValue& value)
+{
+    const auto str = std::get_if<std::string_view>(&value);
+    const auto vec = std::get_if<glm::vec3>(&value);
+    Origin* origin = nullptr;
+
+    switch (m_elements.back()) {
+        case Element::Robot:
+            if (name == "name" && str != nullptr)
+                m_name = *str;
+            break;
+        case Element::Link:
+        case Element::Joint:
+            if (name == "name" && str != nullptr)
+                m_current = *str;
+            break;
+        case Element::VisualOrigin:
+            if (m_visual >= 0)
+                origin = &m_visuals[m_visual].origin;
+            break;
+        case Element::JointOrigin:
+            origin = &m_jointOrigin;
+            break;
+        case Element::Mesh:
+            if (m_visual >= 0 && name == "filename" && str != nullptr)
+                m_visuals[m_visual].meshFile = *str;
+            break;
+        case Element::Parent:
+            if (name == "link" && str != nullptr)
+                m_joint.parent = *str;
+            break;
+        case Element::Child:
+            if (name == "link" && str != nullptr)
+                m_joint.child = *str;
+            break;
+        case Element::Axis:
+            if (name == "xyz" && vec != nullptr)
+                m_axis = glm::normalize(*vec);
+            break;
+        case Element::Limit:
+            if (name == "lower")
+                m_lower = toFloat(value);
+            else if (name == "upper")
+                m_upper = toFloat(value);
+            break;
+        default:
+            break;
+    }
+
+    if (origin != nullptr && vec != nullptr) {
+        if (name == "xyz")
+            origin->xyz = 1000.0f*(*vec);
+        else if (name == "rpy")
+            origin->rpy = *vec;
+    }
+}
+
+void UrdfReader::endElement(const std::string_view /*tag*/)
+{
+    const Element element = m_elements.back();
+    m_elements.pop_back();
+
+    if (element == Element::Link)
+        finishLink();
+    else if (element == Element::Joint)
+        finishJoint();
+    else if (element == Element::Visual || element == Element::Collision)
+        m_visual = -1;
+}
+
+UrdfReader::Element UrdfReader::classify(const std::string_view tag) const
+{
+    const Element parent = m_elements.empty() ? Element::Unknown : m_elements.back();
+
+    if (m_elements.empty())
+        return tag == "robot" ? Element::Robot : Element::Unknown;
+
+    switch (parent) {
+        case Element::Robot:
+            if (tag == "link")      return Element::Link;
+            if (tag == "joint")     return Element::Joint;
+            break;
+        case Element::Link:
+            if (tag == "visual")    return Element::Visual;
+            if (tag == "collision") return Element::Collision;
+            break;
+        case Element::Visual:
+        case Element::Collision:
+            if (tag == "origin")    return Element::VisualOrigin;
+            if (tag == "geometry")  return Element::Geometry;
+            break;
+        case Element::Geometry:
+            if (tag == "mesh")      return Element::Mesh;
+            break;
+        case Element::Joint:
+            if (tag == "origin")    return Element::JointOrigin;
+            if (tag == "parent")    return Element::Parent;
+            if (tag == "child")     return Element::Child;
+            if (tag == "axis")      return Element::Axis;
+            if (tag == "limit")     return Element::Limit;
+            break;
+        default:
+            break;
+    }
+
+    return Element::Unknown;
+}
+
+void UrdfReader::finishLink()
+{
+    if (!m_valid || m_current.empty())
+        return;
+
+    const auto& name = m_current;
+    const Visual* visual = m_visuals[0].present ? &m_visuals[0] : (m_visuals[1].present ? &m_visuals[1] : nullptr);
+    if (visual == nullptr) {
+        LOG_WARN << "Visual node missing: " << name;
+        return;
+    }
+
+    // ------------- Transformation
+
+    glm::mat4 t_mesh_world(1.0f);
+    if (visual->origin.present) {
+        if (!visual->origin.xyz)
+            LOG_WARN << "No xyz specified: " << name;
+        if (!visual->origin.rpy)
+            LOG_WARN << "No rpy specified: " << name;
+
+        t_mesh_world = eulerXYZ(visual->origin.rpy.value_or(glm::vec3(0.0f)));
+        setMat4Translation(t_mesh_world, visual->origin.xyz.value_or(glm::vec3(0.0f)));
+    }
+    else
+        LOG_WARN << "Origin node missing: " << name;
+
+    // ------------- Mesh
+
+    if (!visual->hasGeometry) {
+        LOG_WARN << "Geometry node missing: " << name;
+        m_valid = false;
+        return;
+    }
+    if (!visual->hasMesh) {
+        LOG_ERROR << "Mesh node missing: " << name;
+        m_valid = false;
+        return;
+    }
+    if (visual->meshFile.empty()) {
+        LOG_ERROR << "No mesh-file specified: " << name;
+        m_valid = false;
+        return;
+    }
+
+    if (!m_onLink(UrdfLink{ name, visual->meshFile, t_mesh_world }))
+        m_valid = false;
+}
+
+void UrdfReader::finishJoint()
+{
+    if (!m_valid || m_current.empty())
+        return;
+
+    const auto& name = m_current;
+
+    // ------------- Transformation
+
+    if (!m_jointOrigin.present) {
+        LOG_ERROR << "Origin node missing: " << name;
+        m_valid = false;
+        return;
+    }
+    if (!m_jointOrigin.xyz)
+        LOG_WARN << "No xyz specified: " << name;
+    if (!m_jointOrigin.rpy)
+        LOG_WARN << "No rpy specified: " << name;
+
+    m_joint.parentToChild = eulerXYZ(m_jointOrigin.rpy.value_or(glm::vec3(0.0f)));
+    setMat4Translation(m_joint.parentToChild, m_jointOrigin.xyz.value_or(glm::vec3(0.0f)));
+
+    // ------------- Parent/Child
+
+    if (!m_hasParent) {
+        LOG_ERROR << "Parent node missing: " << name;
+        m_valid = false;
+        return;
+    }
+    if (!m_hasChild) {
+        LOG_ERROR << "Child node missing: " << name;
+        m_valid = false;
+        return;
+    }
+
+    // ------------- Axis
+
+    if (m_hasAxis) {
+        if (!m_axis) {
+            LOG_ERROR << "Axis xyz missing: " << name;
+            m_valid = false;
+            return;
+        }
+        m_joint.rotationAxis = *m_axis;
+    }
+    else
+        LOG_WARN << "Axis node missing: " << name;
+
+    // ------------- Limits
+
+    m_joint.limits = { 0.0f, 0.0f };
+    if (m_hasLimit) {
+        if (m_lower)
+            m_joint.limits.first = *m_lower;
+        else
+            LOG_WARN << "No lower limit specified: " << name;
+
+        if (m_upper)
+            m_joint.limits.second = *m_upper;
+        else
+            LOG_WARN << "No upper limit specified: " << name;
+    }
+    else
+        LOG_WARN << "No limits specified: " << name;
+
+    m_joint.name = name;
+    m_joints.push_back(m_joint);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Xml/XmlSaxParser.h"
+
+struct UrdfLink
+{
+    std::string name;
+    std::string meshFile;
+    glm::mat4 t_mesh_world;
+};
+
+// parent and child are link names, they are resolved once all links are known
+struct UrdfJoint
+{
+    std::string name;
+    std::string parent;
+    std::string child;
+    glm::mat4 parentToChild;
+    glm::vec3 rotationAxis;
+    std::pair<float, float> limits;
+};
+
+// fills links and joints while streaming over the urdf, no dom is built
+class UrdfReader : public XmlSaxHandler
+{
+public:
+    UrdfReader(const std::function<bool(const UrdfLink&)>& onLink);
+
+    bool read(const std::string_view urdf);
+
+    inline const std::string& getName() const { return m_name; }
+    inline const std::vector<UrdfJoint>& getJoints() const { return m_joints; }
+
+private:
+    enum class Element
+    {
+        Unknown,
+        Robot,
+        Link,
+        Joint,
+        Visual,
+        Collision,
+        VisualOrigin,
+        Geometry,
+        Mesh,
+        JointOrigin,
+        Parent,
+        Child,
+        Axis,
+        Limit
+    };
+
+    struct Origin
+    {
+        bool present = false;
+        std::optional<glm::vec3> xyz;
+        std::optional<glm::vec3> rpy;
+    };
+
+    struct Visual
+    {
+        bool present = false;
+        bool hasGeometry = false;
+        bool hasMesh = false;
+        Origin origin;
+        std::string meshFile;
+    };
+
+    virtual void startElement(const std::string_view tag) override;
+    virtual void attribute(const std::string_view name, const XmlValue& value) override;
+    virtual void endElement(const std::string_view tag) override;
+
+    Element classify(const std::string_view tag) const;
+
+    void finishLink();
+    void finishJoint();
+
+    std::function<bool(const UrdfLink&)> m_onLink;
+    bool m_valid;
+
+    std::vector<Element> m_elements;
+    size_t m_numRoots;
+    bool m_hasRobot;
+
+    std::string m_name;
+    std::string m_current;
+
+    // visual and collision of the current link, m_visual indexes the open one
+    std::array<Visual, 2> m_visuals;
+    int m_visual;
+
+    Origin m_jointOrigin;
+    bool m_hasParent, m_hasChild, m_hasAxis, m_hasLimit;
+    std::optional<glm::vec3> m_axis;
+    std::optional<float> m_lower, m_upper;
+    UrdfJoint m_joint;
+
+    std::vector<UrdfJoint> m_joints;
+
+};
@@ -5,6 +5,9 @@
 #include "Events/Event.h"
 
 #include "Util/EdgeDetector.h"
+#include "Util/MinMaxPyramid.h"
+
+class Robot;
 
 class ImGuiLayer
 {
@@ -25,13 +28,26 @@ private:
     static void dockSpace(const std::function<void(const ImGuiID)>& dockspaceContent);
     static void viewport(const ImGuiID dockspaceId);
     static void robotControls(const ImGuiID dockspaceId);
+    static void statistics(const ImGuiID dockspaceId);
+    static void benchmarks(const ImGuiID dockspaceId);
+
+    // one plot per joint sharing a time view, mouse wheel zooms, dragging pans, double click resets
+    static void trajectoryPlots(const std::string& name, const Robot& robot, const double currentTime);
    
     static std::pair<uint16_t, uint16_t> s_viewportSize;
     static glm::vec2 s_viewportPos;
     static bool s_viewportHovered;
     static bool s_viewportFocused;
 
-    static EdgeDetector<float> m_sliderTime;
+    static EdgeDetector<double> m_sliderTime;
     static EdgeDetector<bool> m_buttonPlay;
 
+    // joints moved in the robot panel this frame
+    static std::vector<size_t> s_changedJoints;
+
+    static std::unordered_map<std::string, std::pair<double, double>> s_plotViews;
+    static bool s_plotVelocities;
+    static std::vector<MinMaxPyramid::Bin> s_plotBins;
+    static std::vector<ImVec2> s_plotPoints;
+
 };
\ No newline at end of file
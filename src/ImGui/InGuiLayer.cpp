@@ -2,11 +2,16 @@
 
 #include "ImGuiLayer.h"
 #include "Scene.h"
+#include "Simulation.h"
 
 #include "Window/Window.h"
 
 #include "Entities/Robot.h"
 
+#include "Renderer/Renderer.h"
+
+#include "Benchmarks/Benchmarks.h"
+
 #include "Util/Log.h"
 #include "Util/geometry.h"
 
@@ -14,8 +19,13 @@ std::pair<uint16_t, uint16_t> ImGuiLayer::s_viewportSize;
 glm::vec2 ImGuiLayer::s_viewportPos;
 bool ImGuiLayer::s_viewportHovered;
 bool ImGuiLayer::s_viewportFocused;
-EdgeDetector<float> ImGuiLayer::m_sliderTime;
+EdgeDetector<double> ImGuiLayer::m_sliderTime;
 EdgeDetector<bool> ImGuiLayer::m_buttonPlay;
+std::unordered_map<std::string, std::pair<double, double>> ImGuiLayer::s_plotViews;
+bool ImGuiLayer::s_plotVelocities = false;
+std::vector<MinMaxPyramid::Bin> ImGuiLayer::s_plotBins;
+std::vector<ImVec2> ImGuiLayer::s_plotPoints;
+std::vector<size_t> ImGuiLayer::s_changedJoints;
 
 void ImGuiLayer::init()
 {
@@ -64,6 +74,8 @@ void ImGuiLayer::render(const Timestep dt)
     dockSpace([](const ImGuiID dockspaceId) {
 		viewport(dockspaceId);
 		robotControls(dockspaceId);
+		statistics(dockspaceId);
+		benchmarks(dockspaceId);
 	});
 
 	ImGuiIO& io = ImGui::GetIO();
@@ -163,7 +175,12 @@ void ImGuiLayer::robotControls(const ImGuiID dockspaceId)
 {
 	for (auto&[name, entity] : Scene::getEntities()) {
 		if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr) {
-			auto& controlData = robot->getControlData();
+			// the simulation steps under the same lock, widgets work on a copy and only changes are written back
+			RobotControlData controlData;
+			{
+				std::lock_guard<std::mutex> lock(robot->getControlMutex());
+				controlData = robot->getControlData();
+			}
 			const auto& joints = robot->getJoints();
 
 			// ImGui::SetNextWindowDockID(dockspaceId);
@@ -171,39 +188,73 @@ void ImGuiLayer::robotControls(const ImGuiID dockspaceId)
 
 			ImGui::Text("%s", robot->getName().c_str());
 
+			if (robot->isLoading()) {
+				const std::string progress = std::to_string(robot->numMeshesLoaded()) + "/" + std::to_string(robot->numMeshes()) + " meshes";
+				ImGui::ProgressBar(static_cast<float>(robot->numMeshesLoaded()) / robot->numMeshes(), ImVec2(-1.0f, 0.0f), progress.c_str());
+			}
+			if (robot->isLoadingTrajectory()) {
+				const std::string progress = "trajectory " + std::to_string(static_cast<int>(robot->getTrajectoryProgress()*100.0f)) + "%";
+				ImGui::ProgressBar(robot->getTrajectoryProgress(), ImVec2(-1.0f, 0.0f), progress.c_str());
+			}
+
 			ImGui::Separator();
 
+			s_changedJoints.clear();
 			ImGui::Text("%s", "Joint values:");
 			for (size_t i = 0; i < controlData.jointValues.size(); ++i) {
-				ImGui::SliderAngle(joints[i]->name.c_str(), &controlData.jointValues[i], rad2deg(joints[i]->limits.first), rad2deg(joints[i]->limits.second));
+				if (ImGui::SliderAngle(joints[i]->name.c_str(), &controlData.jointValues[i], rad2deg(joints[i]->limits.first), rad2deg(joints[i]->limits.second)))
+					s_changedJoints.push_back(i);
 			}
 			ImGui::Separator();
 
-			ImGui::Checkbox("Frames", &controlData.drawFrames);
-			ImGui::Checkbox("Bounding Boxes", &controlData.drawBoundingBoxes);
+			const bool framesChanged = ImGui::Checkbox("Frames", &controlData.drawFrames);
+			const bool boundingBoxesChanged = ImGui::Checkbox("Bounding Boxes", &controlData.drawBoundingBoxes);
 
 			ImGui::Separator();
 
+			bool timeChanged = false, activeChanged = false, sampleTime = false;
 			if (controlData.trajectory) {
+				auto& [active, currentTime, sampler, cursor] = *controlData.trajectory;
+				const double startTime = sampler->startTime();
+				const double endTime = sampler->endTime();
 				ImGui::SetNextItemWidth(0.94 * ImGui::GetCurrentWindow()->Size.x);
-				ImGui::SliderFloat("##Traj", &controlData.trajectory->currentTime, controlData.trajectory->times.front(), controlData.trajectory->times.back());				
-				m_sliderTime.val() = controlData.trajectory->currentTime;
-				if (m_sliderTime().edge() && !controlData.trajectory->active && controlData.trajectory->currentIndex > 0 && controlData.trajectory->currentIndex < controlData.trajectory->jointValues.size()) {
-					// controlData.jointValues = controlData.trajectory->jointValues[controlData.trajectory->currentIndex];
-					for (size_t i = 0; i < robot->numJoints(); ++i) {           
-						controlData.jointValues[i] = map(
-							controlData.trajectory->currentTime, 
-							controlData.trajectory->times[controlData.trajectory->currentIndex-1], 			controlData.trajectory->times[controlData.trajectory->currentIndex], 
-							controlData.trajectory->jointValues[controlData.trajectory->currentIndex-1][i], controlData.trajectory->jointValues[controlData.trajectory->currentIndex][i]); 
-					} 
-				}
+				timeChanged = ImGui::SliderScalar("##Traj", ImGuiDataType_Double, &currentTime, &startTime, &endTime, "%.3f");
+				m_sliderTime.val() = currentTime;
+				sampleTime = m_sliderTime().edge() && !active;
 
 				m_buttonPlay.val() = ImGui::ImageButton("play", TextureLibrary::get("image")->getId(), ImVec2(20, 20), ImVec2(0, 1), ImVec2(1, 0));
 				if (m_buttonPlay().rising()) {
-					controlData.trajectory->active = !controlData.trajectory->active;
+					active = !active;
+					activeChanged = true;
+				}
+			}
+
+			if (!s_changedJoints.empty() || framesChanged || boundingBoxesChanged || timeChanged || activeChanged || sampleTime) {
+				std::lock_guard<std::mutex> lock(robot->getControlMutex());
+				auto& data = robot->getControlData();
+				for (const size_t i : s_changedJoints)
+					data.jointValues[i] = controlData.jointValues[i];
+				if (framesChanged)
+					data.drawFrames = controlData.drawFrames;
+				if (boundingBoxesChanged)
+					data.drawBoundingBoxes = controlData.drawBoundingBoxes;
+
+				// a trajectory installed meanwhile is left alone
+				if (data.trajectory && controlData.trajectory && data.trajectory->sampler == controlData.trajectory->sampler) {
+					auto& trajectory = *data.trajectory;
+					if (timeChanged)
+						trajectory.currentTime = controlData.trajectory->currentTime;
+					if (activeChanged)
+						trajectory.active = controlData.trajectory->active;
+					if (sampleTime)
+						trajectory.sampler->sample(controlData.trajectory->currentTime, trajectory.cursor, data.jointValues);
 				}
 			}
 
+			// only reads the immutable plots, so it stays out of the lock
+			if (controlData.trajectory)
+				trajectoryPlots(name, *robot, controlData.trajectory->currentTime);
+
 			ImGui::End();
 		}
 	}
@@ -221,4 +272,180 @@ void ImGuiLayer::robotControls(const ImGuiID dockspaceId)
 	// ImGui::Checkbox("Bounding Boxes", &s_bbActive);
 
 	// ImGui::End();
+}
+
+void ImGuiLayer::trajectoryPlots(const std::string& name, const Robot& robot, const double currentTime)
+{
+	if (!ImGui::CollapsingHeader("Plots"))
+		return;
+
+	const auto& plots = robot.getTrajectoryPlots();
+	if (!plots) {
+		ImGui::TextDisabled("%s", "building plots...");
+		return;
+	}
+	ImGui::Checkbox("Velocities", &s_plotVelocities);
+
+	const auto& sampler = *plots->sampler;
+	const auto times = sampler.getTimes();
+	const double duration = sampler.endTime() - sampler.startTime();
+	if (duration <= 0.0)
+		return;
+	const double minSpan = std::min(duration, 10.0 * duration / std::max<size_t>(sampler.numSamples(), 1));
+	auto& [viewStart, viewEnd] = s_plotViews.try_emplace(name, sampler.startTime(), sampler.endTime()).first->second;
+
+	const ImGuiIO& io = ImGui::GetIO();
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const ImVec2 size(ImGui::GetContentRegionAvail().x, 60.0f);
+	const auto& joints = robot.getJoints();
+
+	for (size_t j = 0; j < sampler.numJoints() && j < joints.size() && size.x > 0.0f; ++j) {
+		const auto& pyramid = s_plotVelocities ? plots->velocities[j] : plots->positions[j];
+		ImGui::Text("%s", joints[j]->name.c_str());
+
+		const ImVec2 p0 = ImGui::GetCursorScreenPos();
+		const ImVec2 p1(p0.x + size.x, p0.y + size.y);
+		ImGui::InvisibleButton(("##plot" + std::to_string(j)).c_str(), size);
+
+		// the view is clamped to the recording after every change
+		double span = std::clamp(viewEnd - viewStart, minSpan, duration);
+		if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+			const double mouseTime = viewStart + (io.MousePos.x - p0.x) / size.x * span;
+			const double newSpan = std::clamp(span * std::pow(0.8, io.MouseWheel), minSpan, duration);
+			viewStart = mouseTime - (mouseTime - viewStart) * newSpan / span;
+			span = newSpan;
+		}
+		if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+			viewStart -= io.MouseDelta.x / size.x * span;
+		if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+			viewStart = sampler.startTime();
+			span = duration;
+		}
+		viewStart = std::clamp(viewStart, sampler.startTime(), sampler.endTime() - span);
+		viewEnd = viewStart + span;
+
+		// values within their extremes, positions also show the joint limits unless the joint has none
+		const auto& [limitMin, limitMax] = joints[j]->limits;
+		const auto& range = pyramid.getRange();
+		const bool showLimits = !s_plotVelocities && limitMax > limitMin;
+		const float yMin = showLimits ? std::min(range.min, limitMin) : range.min;
+		const float yMax = showLimits ? std::max(range.max, limitMax) : range.max;
+		const auto toX = [&](const double t) { return p0.x + static_cast<float>((t - viewStart) / span) * size.x; };
+		const auto toY = [&](const float v) { return p1.y - (yMax > yMin ? (v - yMin) / (yMax - yMin) : 0.5f) * size.y; };
+
+		drawList->AddRectFilled(p0, p1, ImGui::GetColorU32(ImGuiCol_FrameBg));
+		drawList->PushClipRect(p0, p1, true);
+
+		// samples touching the view, merged into about two points per pixel
+		const size_t first = std::max<size_t>(std::upper_bound(times.begin(), times.end(), viewStart) - times.begin(), 1) - 1;
+		const size_t last = std::min<size_t>(std::lower_bound(times.begin(), times.end(), viewEnd) - times.begin() + 1, times.size());
+		size_t firstSample;
+		const size_t binSize = pyramid.query(first, last, static_cast<size_t>(size.x), s_plotBins, firstSample);
+
+		s_plotPoints.clear();
+		for (size_t b = 0; b < s_plotBins.size(); ++b) {
+			const float x = toX(times[firstSample + b*binSize]);
+			s_plotPoints.emplace_back(x, toY(s_plotBins[b].max));
+			if (binSize > 1)
+				s_plotPoints.emplace_back(x, toY(s_plotBins[b].min));
+		}
+		drawList->AddPolyline(s_plotPoints.data(), static_cast<int>(s_plotPoints.size()), ImGui::GetColorU32(ImGuiCol_PlotLines), ImDrawFlags_None, 1.0f);
+
+		const float cursor = toX(currentTime);
+		drawList->AddLine(ImVec2(cursor, p0.y), ImVec2(cursor, p1.y), ImGui::GetColorU32(ImGuiCol_PlotLinesHovered));
+		drawList->PopClipRect();
+	}
+}
+
+void ImGuiLayer::statistics(const ImGuiID /*dockspaceId*/)
+{
+	ImGui::Begin("Statistics");
+
+	const auto triStats = Entity::getTriangulationStats();
+	ImGui::Text("%s", "Triangulation updates:");
+	ImGui::Text("  performed: %llu", static_cast<unsigned long long>(triStats.updates));
+	ImGui::Text("  avoided:   %llu", static_cast<unsigned long long>(triStats.updatesAvoided));
+
+	const auto& renderStats = Renderer::getStats();
+	ImGui::Separator();
+	ImGui::Text("%s", "Rendering:");
+	ImGui::Text("  packets:    %zu", renderStats.packets);
+	ImGui::Text("  draw calls: %zu", renderStats.drawCalls);
+	ImGui::Text("  instances:  %zu", renderStats.instances);
+	ImGui::Text("  state changes: %zu (%zu avoided)", renderStats.stateChanges, renderStats.stateChangesAvoided);
+
+	const auto simStats = Simulation::getStats();
+	ImGui::Separator();
+	ImGui::Text("%s", "Simulation:");
+	ImGui::Text("  rate:    %.0f Hz (%.0f Hz target)", simStats.steps / Simulation::now(), 1.0 / Simulation::s_step);
+	ImGui::Text("  step:    %.3f ms", simStats.stepTimeMs);
+	ImGui::Text("  dropped: %llu steps", static_cast<unsigned long long>(simStats.stepsDropped));
+
+	const auto& cullingStats = Scene::getCullingStats();
+	ImGui::Separator();
+	ImGui::Text("%s", "Frustum culling:");
+	ImGui::Text("  entities: %zu of %zu culled", cullingStats.entitiesCulled, cullingStats.entitiesTested);
+	ImGui::Text("  links:    %zu of %zu culled", cullingStats.linksCulled, cullingStats.linksTested);
+	ImGui::Text("  meshlets: %zu of %zu culled", cullingStats.meshletsCulled, cullingStats.meshletsTested);
+
+	// cpu side mesh data, the gpu buffers hold the same vertices and indices,
+	// shared geometry is counted once
+	size_t numVertices = 0, numIndexBytes = 0, numMeshletBytes = 0, numInstances = 0;
+	std::unordered_set<const MeshGeometry*> geometries;
+	const auto addMesh = [&](const Mesh& mesh) {
+		if (!mesh.hasGeometry())
+			return;
+		numInstances++;
+		const auto geometry = mesh.getGeometry();
+		if (!geometries.insert(geometry.get()).second)
+			return;
+		for (const auto& meshData : geometry->meshData) {
+			numVertices += meshData.vertices.size();
+			numIndexBytes += meshData.indices.size()*sizeof(meshData.indices[0]);
+			numMeshletBytes += meshData.meshlets.size()*sizeof(Meshlet);
+		}
+	};
+	for (const auto&[name, entity] : Scene::getEntities()) {
+		if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr)
+			for (const auto&[linkName, link] : robot->getLinks())
+				addMesh(*link->mesh);
+		else if (auto mesh = dynamic_cast<Mesh*>(entity.get()); mesh != nullptr)
+			addMesh(*mesh);
+	}
+
+	// position vec3 and color vec4 per vertex before the compressed format
+	constexpr size_t legacyVertexSize = sizeof(glm::vec3) + sizeof(glm::vec4);
+	constexpr float mib = 1.0f / (1024.0f*1024.0f);
+	ImGui::Separator();
+	ImGui::Text("%s", "Mesh memory:");
+	ImGui::Text("  meshes:    %zu instances, %zu unique", numInstances, geometries.size());
+	ImGui::Text("  library:   %zu assets", MeshLibrary::numAssets());
+	ImGui::Text("  vertices:  %zu (%zu bytes each)", numVertices, sizeof(MeshData::Vertex));
+	ImGui::Text("  vertex:    %.2f MiB (%.2f MiB uncompressed)", numVertices*sizeof(MeshData::Vertex)*mib, numVertices*legacyVertexSize*mib);
+	ImGui::Text("  index:     %.2f MiB", numIndexBytes*mib);
+	ImGui::Text("  meshlets:  %.2f MiB", numMeshletBytes*mib);
+
+	ImGui::End();
+}
+
+void ImGuiLayer::benchmarks(const ImGuiID /*dockspaceId*/)
+{
+	ImGui::Begin("Benchmarks");
+
+	if (ImGui::Button("Picking"))
+		Benchmarks::picking();
+	if (ImGui::Button("Robot load"))
+		Benchmarks::robotLoad();
+	if (ImGui::Button("Xml parse"))
+		Benchmarks::xmlParse();
+	if (ImGui::Button("Xml attributes"))
+		Benchmarks::xmlAttributes();
+	if (ImGui::Button("Forward kinematics"))
+		Benchmarks::forwardKinematics();
+	if (ImGui::Button("Trajectory sampling"))
+		Benchmarks::trajectorySampling();
+	if (ImGui::Button("Trajectory parse"))
+		Benchmarks::trajectoryParse();
+
+	ImGui::End();
 }
\ No newline at end of file
@@ -12,10 +12,10 @@ VertexBuffer::~VertexBuffer()
     glDeleteBuffers(1, &m_buffer);
 }
 
-void VertexBuffer::allocate(const GLfloat* vertices, const size_t count)
+void VertexBuffer::allocate(const GLfloat* vertices, const size_t count, const GLenum usage)
 {
     glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
-    glBufferData(GL_ARRAY_BUFFER, count*sizeof(GLfloat), vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, count*sizeof(GLfloat), vertices, usage);
 }
 
 void VertexBuffer::bind() const
@@ -30,8 +30,37 @@ void VertexBuffer::release() const
 
 // ------------------------------------------------------
 
+UniformBuffer::UniformBuffer()
+{
+    glGenBuffers(1, &m_buffer);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void UniformBuffer::allocate(const size_t size)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+}
+
+void UniformBuffer::setData(const void* data, const size_t size, const size_t offset)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::bindBase(const GLuint binding) const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_buffer);
+}
+
+// ------------------------------------------------------
+
 IndexBuffer::IndexBuffer() 
-    : m_count(0)
+    : m_count(0), m_type(GL_UNSIGNED_SHORT)
 {
     glGenBuffers(1, &m_buffer);
 }
@@ -44,10 +73,19 @@ IndexBuffer::~IndexBuffer()
 void IndexBuffer::allocate(const GLushort* indices, const size_t count)
 {
     m_count = count;
+    m_type = GL_UNSIGNED_SHORT;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count*sizeof(GLushort), indices, GL_STATIC_DRAW);
 }
 
+void IndexBuffer::allocate(const GLuint* indices, const size_t count)
+{
+    m_count = count;
+    m_type = GL_UNSIGNED_INT;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count*sizeof(GLuint), indices, GL_STATIC_DRAW);
+}
+
 void IndexBuffer::bind() const
 {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
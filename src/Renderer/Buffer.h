@@ -16,7 +16,15 @@ enum class ShaderDataType {
     Int4,
     Int2x2,
     Int3x3,
-    Int4x4
+    Int4x4,
+    Half2,
+    Half3,
+    Half4,
+    Byte2,
+    Byte4,
+    UByte4,
+    Short3,
+    UShort3
 };
 
 static size_t shaderDataTypeSize(const ShaderDataType type)
@@ -37,6 +45,14 @@ static size_t shaderDataTypeSize(const ShaderDataType type)
         case ShaderDataType::Int2x2:     return sizeof(GLint)*2*2;
         case ShaderDataType::Int3x3:     return sizeof(GLint)*3*3;
         case ShaderDataType::Int4x4:     return sizeof(GLint)*4*4;
+        case ShaderDataType::Half2:      return sizeof(GLhalf)*2;
+        case ShaderDataType::Half3:      return sizeof(GLhalf)*3;
+        case ShaderDataType::Half4:      return sizeof(GLhalf)*4;
+        case ShaderDataType::Byte2:      return sizeof(GLbyte)*2;
+        case ShaderDataType::Byte4:      return sizeof(GLbyte)*4;
+        case ShaderDataType::UByte4:     return sizeof(GLubyte)*4;
+        case ShaderDataType::Short3:     return sizeof(GLshort)*3;
+        case ShaderDataType::UShort3:    return sizeof(GLushort)*3;
         case ShaderDataType::None:       return 0;
     }
 
@@ -75,6 +91,14 @@ struct BufferElement {
             case ShaderDataType::Int2x2:     return 2*2;
             case ShaderDataType::Int3x3:     return 3*3;
             case ShaderDataType::Int4x4:     return 4*4;
+            case ShaderDataType::Half2:      return 2;
+            case ShaderDataType::Half3:      return 3;
+            case ShaderDataType::Half4:      return 4;
+            case ShaderDataType::Byte2:      return 2;
+            case ShaderDataType::Byte4:      return 4;
+            case ShaderDataType::UByte4:     return 4;
+            case ShaderDataType::Short3:     return 3;
+            case ShaderDataType::UShort3:    return 3;
             case ShaderDataType::None:       return 0;
         }
 
@@ -126,7 +150,7 @@ public:
     VertexBuffer();
     ~VertexBuffer();
 
-    void allocate(const GLfloat* vertices, const size_t count);
+    void allocate(const GLfloat* vertices, const size_t count, const GLenum usage = GL_STATIC_DRAW);
 
     void bind() const;
     void release() const;
@@ -139,6 +163,21 @@ private:
     BufferLayout m_layout;
 };
 
+class UniformBuffer
+{
+public:
+    UniformBuffer();
+    ~UniformBuffer();
+
+    void allocate(const size_t size);
+    void setData(const void* data, const size_t size, const size_t offset = 0);
+
+    void bindBase(const GLuint binding) const;
+
+private:
+    GLuint m_buffer;
+};
+
 class IndexBuffer  
 {
 public:
@@ -146,13 +185,16 @@ public:
     ~IndexBuffer();
 
     void allocate(const GLushort* indices, const size_t count);
+    void allocate(const GLuint* indices, const size_t count);
 
     void bind() const;
     void release() const;
 
     inline size_t getCount() const { return m_count; }
+    inline GLenum getType() const { return m_type; }
 
 private: 
     GLuint m_buffer;
     size_t m_count;
+    GLenum m_type;
 };
\ No newline at end of file
@@ -2,11 +2,35 @@
 
 #include "Renderer.h"
 
+std::shared_ptr<UniformBuffer> Renderer::s_cameraBuffer;
+std::vector<DrawPacket> Renderer::s_queue;
+std::vector<std::tuple<uint64_t, uint64_t, uint32_t>> Renderer::s_order;
+std::vector<InstanceData> Renderer::s_instances;
+std::shared_ptr<VertexBuffer> Renderer::s_instanceBuffer;
+RenderStats Renderer::s_stats;
+
+size_t Renderer::s_uploadBudget = Renderer::s_uploadBudgetPerFrame;
+
 void Renderer::init()
 {
     glEnable(GL_DEPTH_TEST);
     glClearDepthf(1.0f);
     glDepthFunc(GL_LESS);
+
+    // entities only look shaders up, nothing compiles on first use
+    ShaderLibrary::loadEmbedded();
+
+    s_instanceBuffer = std::make_shared<VertexBuffer>();
+    BufferLayout layout = {
+        { ShaderDataType::Float4x4, "a_model" },
+        { ShaderDataType::Float4, "a_color" },
+        { ShaderDataType::Float4, "a_positionScale" },
+        { ShaderDataType::Float4, "a_positionOffset" }
+    };
+    s_instanceBuffer->setLayout(layout);
+
+    s_cameraBuffer = std::make_shared<UniformBuffer>();
+    s_cameraBuffer->allocate(sizeof(CameraData));
 }
 
 void Renderer::clear(const glm::vec4& clearColor)
@@ -15,9 +39,113 @@ void Renderer::clear(const glm::vec4& clearColor)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Renderer::draw(const std::shared_ptr<Shader>& shader, const VertexArray& vertexArray)
+void Renderer::beginScene(const Camera& camera)
+{
+    // the only per frame uniforms, shared by every program through the camera block
+    const CameraData cameraData(camera.getView(), camera.getProjection(), camera.getProjection() * camera.getView());
+    s_cameraBuffer->setData(&cameraData, sizeof(CameraData));
+    s_cameraBuffer->bindBase(Shader::s_cameraBlockBinding);
+
+    s_queue.clear();
+    s_stats = {};
+}
+
+void Renderer::submit(const DrawPacket& packet)
 {
-    shader->bind();
-    vertexArray.bind();
-    glDrawElements(GL_TRIANGLES, vertexArray.getIndexBuffer()->getCount(), GL_UNSIGNED_SHORT, 0);
+    s_queue.push_back(packet);
 }
+
+void Renderer::submit(const std::shared_ptr<Shader>& shader, const VertexArray& vertexArray, const glm::mat4& model, const glm::vec4& color, const std::shared_ptr<Texture2D>& texture)
+{
+    s_queue.emplace_back(shader.get(), texture.get(), &vertexArray, 0, 0, InstanceData(model, color));
+}
+
+void Renderer::endScene()
+{
+    s_stats.packets = s_queue.size();
+    if (s_queue.empty())
+        return;
+
+    // sort small keys instead of the packets, equal index ranges end up next to each other, ties keep the submission order
+    s_order.clear();
+    for (uint32_t i = 0; i < s_queue.size(); ++i)
+        s_order.emplace_back(sortKey(s_queue[i]), uint64_t(s_queue[i].firstIndex) << 32 | s_queue[i].numIndices, i);
+    std::sort(s_order.begin(), s_order.end());
+
+    // one upload for the whole queue, each draw points the instance attributes at its own range
+    s_instances.clear();
+    for (const auto& [key, range, i] : s_order)
+        s_instances.push_back(s_queue[i].instance);
+    s_instanceBuffer->allocate(reinterpret_cast<const GLfloat*>(s_instances.data()), s_instances.size()*sizeof(InstanceData)/sizeof(GLfloat), GL_STREAM_DRAW);
+
+    const Shader* shader = nullptr;
+    const Texture2D* texture = nullptr;
+    const VertexArray* vertexArray = nullptr;
+    size_t naiveStateChanges = 0;
+
+    for (size_t first = 0; first < s_order.size();) {
+        const DrawPacket& packet = s_queue[std::get<2>(s_order[first])];
+        size_t count = 1;
+        while (first + count < s_order.size() && isSameDraw(packet, s_queue[std::get<2>(s_order[first + count])]))
+            count++;
+        naiveStateChanges += count*(packet.texture ? 3 : 2);
+
+        if (packet.shader != shader) {
+            shader = packet.shader;
+            shader->bind();
+            s_stats.stateChanges++;
+        }
+        if (packet.texture && packet.texture != texture) {
+            texture = packet.texture;
+            texture->bind();
+            s_stats.stateChanges++;
+        }
+        if (packet.vertexArray != vertexArray) {
+            vertexArray = packet.vertexArray;
+            vertexArray->bind();
+            s_stats.stateChanges++;
+        }
+
+        vertexArray->setInstanceBuffer(*s_instanceBuffer, first*sizeof(InstanceData));
+        const auto& indexBuffer = vertexArray->getIndexBuffer();
+        const size_t indexSize = indexBuffer->getType() == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+        const size_t numIndices = packet.numIndices > 0 ? packet.numIndices : indexBuffer->getCount();
+        glDrawElementsInstanced(GL_TRIANGLES, numIndices, indexBuffer->getType(), (const void*)(packet.firstIndex*indexSize), count);
+
+        s_stats.drawCalls++;
+        s_stats.instances += count;
+        first += count;
+    }
+
+    s_stats.stateChangesAvoided = naiveStateChanges - s_stats.stateChanges;
+    s_queue.clear();
+}
+
+uint64_t Renderer::sortKey(const DrawPacket& packet)
+{
+    // gl names are small and increasing, 16 bits for shader and texture, 32 for the vertex array
+    const uint64_t shader = packet.shader->getId() & 0xffff;
+    const uint64_t texture = packet.texture ? packet.texture->getId() & 0xffff : 0;
+    const uint64_t vertexArray = packet.vertexArray->getId();
+    return shader << 48 | texture << 32 | vertexArray;
+}
+
+bool Renderer::isSameDraw(const DrawPacket& a, const DrawPacket& b)
+{
+    return a.shader == b.shader && a.texture == b.texture && a.vertexArray == b.vertexArray && a.firstIndex == b.firstIndex && a.numIndices == b.numIndices;
+}
+
+void Renderer::resetUploadBudget()
+{
+    s_uploadBudget = s_uploadBudgetPerFrame;
+}
+
+bool Renderer::acquireUploadBudget(const size_t bytes)
+{
+    // the first upload of a frame always passes, otherwise oversized buffers would never get through
+    if (bytes > s_uploadBudget && s_uploadBudget != s_uploadBudgetPerFrame)
+        return false;
+
+    s_uploadBudget -= std::min(bytes, s_uploadBudget);
+    return true;
+}
\ No newline at end of file
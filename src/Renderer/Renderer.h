@@ -3,6 +3,40 @@
 #include "Shader.h"
 #include "VertexArray.h"
 #include "Texture.h"
+#include "Camera.h"
+
+// per instance attributes of the instanced shaders
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 color;
+
+    // applied to the vertex position before the model, quantized meshes map it into mesh space
+    glm::vec4 positionScale = glm::vec4(1.0f);
+    glm::vec4 positionOffset = glm::vec4(0.0f);
+};
+
+// one instance of an indexed draw, the pointers have to stay valid until endScene()
+struct DrawPacket
+{
+    const Shader* shader;
+    const Texture2D* texture;
+    const VertexArray* vertexArray;
+    uint32_t firstIndex;
+    uint32_t numIndices; // 0 draws the whole index buffer
+    InstanceData instance;
+};
+
+struct RenderStats
+{
+    size_t packets;
+    size_t drawCalls;
+    size_t instances;
+
+    // binds of shaders, textures and vertex arrays, avoided ones are counted against a bind per packet
+    size_t stateChanges;
+    size_t stateChangesAvoided;
+};
 
 class Renderer {
 
@@ -10,5 +44,40 @@ public:
     static void init();
 
     static void clear(const glm::vec4& clearColor);
-    static void draw(const std::shared_ptr<Shader>& shader, const VertexArray& vertexArray);
-};
+
+    // packets are queued until endScene(), sorted by shader, material and vertex array,
+    // then equal neighbours go out as one instanced draw
+    static void beginScene(const Camera& camera);
+    static void submit(const DrawPacket& packet);
+    static void submit(const std::shared_ptr<Shader>& shader, const VertexArray& vertexArray, const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f), const std::shared_ptr<Texture2D>& texture = nullptr);
+    static void endScene();
+
+    inline static const RenderStats& getStats() { return s_stats; }
+
+    static void resetUploadBudget();
+    static bool acquireUploadBudget(const size_t bytes);
+
+private:
+    // std140, mat4 columns are 16 byte aligned like in glm
+    struct CameraData
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+    };
+    static_assert(sizeof(CameraData) == 3*64, "Camera block has to match the std140 layout");
+
+    static uint64_t sortKey(const DrawPacket& packet);
+    static bool isSameDraw(const DrawPacket& a, const DrawPacket& b);
+
+    static std::shared_ptr<UniformBuffer> s_cameraBuffer;
+    static std::vector<DrawPacket> s_queue;
+    // sort key, index range and queue position
+    static std::vector<std::tuple<uint64_t, uint64_t, uint32_t>> s_order;
+    static std::vector<InstanceData> s_instances;
+    static std::shared_ptr<VertexBuffer> s_instanceBuffer;
+    static RenderStats s_stats;
+
+    static size_t s_uploadBudget;
+    inline static constexpr size_t s_uploadBudgetPerFrame = 8*1024*1024;
+};
\ No newline at end of file
@@ -2,6 +2,20 @@
 
 #include "Shader.h"
 
+#include "Util/Log.h"
+#include "Util/util.h"
+
+#include "EmbeddedShaders.h"
+
+// header of a cached program binary, the compile time is kept to report what the cache saves
+struct ProgramBinaryHeader
+{
+    uint64_t hash;
+    uint32_t format;
+    uint32_t size;
+    float compileMs;
+};
+
 Shader::Shader(const std::string& name)
     : m_name(name)
 {
@@ -64,83 +78,76 @@ void Shader::setAttributeBuffer(const GLint location, const GLint size, const GL
     }
 }
 
-void Shader::uploadInt(const std::string& name, const int i) const
+void Shader::uploadInt(const GLint location, const int i) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniform1i(location, i);
 }
 
-void Shader::uploadFloat(const std::string& name, const float f) const
+void Shader::uploadFloat(const GLint location, const float f) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniform1f(location, f);
 }
 
-void Shader::uploadVec2(const std::string& name, const glm::vec2& vec) const
+void Shader::uploadVec2(const GLint location, const glm::vec2& vec) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniform2fv(location, 1, glm::value_ptr(vec));
 }
 
-void Shader::uploadVec3(const std::string& name, const glm::vec3& vec) const
+void Shader::uploadVec3(const GLint location, const glm::vec3& vec) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniform3fv(location, 1, glm::value_ptr(vec));
 }
 
-void Shader::uploadVec4(const std::string& name, const glm::vec4& vec) const
+void Shader::uploadVec4(const GLint location, const glm::vec4& vec) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniform4fv(location, 1, glm::value_ptr(vec));
 }
 
-void Shader::uploadMat3(const std::string& name, const glm::mat3& mat) const
+void Shader::uploadMat3(const GLint location, const glm::mat3& mat) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(mat));
 }
 
-void Shader::uploadMat4(const std::string& name, const glm::mat4& mat) const
+void Shader::uploadMat4(const GLint location, const glm::mat4& mat) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist\n";
-        return;
-    }
-
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
 }
 
+void Shader::uploadInt(const std::string& name, const int i) const
+{
+    uploadInt(uniformLocation(name), i);
+}
+
+void Shader::uploadFloat(const std::string& name, const float f) const
+{
+    uploadFloat(uniformLocation(name), f);
+}
+
+void Shader::uploadVec2(const std::string& name, const glm::vec2& vec) const
+{
+    uploadVec2(uniformLocation(name), vec);
+}
+
+void Shader::uploadVec3(const std::string& name, const glm::vec3& vec) const
+{
+    uploadVec3(uniformLocation(name), vec);
+}
+
+void Shader::uploadVec4(const std::string& name, const glm::vec4& vec) const
+{
+    uploadVec4(uniformLocation(name), vec);
+}
+
+void Shader::uploadMat3(const std::string& name, const glm::mat3& mat) const
+{
+    uploadMat3(uniformLocation(name), mat);
+}
+
+void Shader::uploadMat4(const std::string& name, const glm::mat4& mat) const
+{
+    uploadMat4(uniformLocation(name), mat);
+}
+
 bool Shader::compile(const GLenum type, const GLchar* source)
 {
     GLuint shader;
@@ -186,6 +193,7 @@ bool Shader::compile(const GLenum type, const GLchar* source)
 
 bool Shader::link()
 {
+    glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_program);
 
     GLint linked = 0;
@@ -212,17 +220,104 @@ bool Shader::link()
     glDeleteShader(m_fragmentShader);
     glDeleteShader(m_vertexShader);
 
+    reflectUniforms();
+    bindUniformBlocks();
+
+    return true;
+}
+
+bool Shader::loadBinary(const std::filesystem::path& file, const uint64_t hash, float& compileMs)
+{
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream.is_open())
+        return false;
+
+    ProgramBinaryHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.hash != hash)
+        return false;
+
+    std::vector<char> binary(header.size);
+    if (!stream.read(binary.data(), binary.size()))
+        return false;
+
+    // drivers may still reject a binary after an update that kept the version string
+    glProgramBinary(m_program, header.format, binary.data(), binary.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+        return false;
+
+    reflectUniforms();
+    bindUniformBlocks();
+
+    compileMs = header.compileMs;
     return true;
 }
 
-GLint Shader::getUniformLocation(const std::string& name) const
+bool Shader::saveBinary(const std::filesystem::path& file, const uint64_t hash, const float compileMs) const
 {
-    GLint location = glGetUniformLocation(m_program, name.c_str());
-    if (location == -1) {
-        std::cerr << "Uniform " << name << " doesnt exist" << '\n';
+    GLint size = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return false;
+
+    std::vector<char> binary(size);
+    GLenum format = 0;
+    glGetProgramBinary(m_program, size, &size, &format, binary.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+        return false;
+
+    const ProgramBinaryHeader header(hash, format, static_cast<uint32_t>(size), compileMs);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(binary.data(), size);
+    return stream.good();
+}
+
+GLint Shader::uniformLocation(const std::string& name) const
+{
+    if (const auto it = m_uniforms.find(name); it != m_uniforms.end())
+        return it->second;
+
+    LOG_WARN << "Uniform " << name << " doesnt exist in shader " << m_name;
+    m_uniforms.emplace(name, -1);
+    return -1;
+}
+
+void Shader::reflectUniforms()
+{
+    m_uniforms.clear();
+
+    GLint numUniforms = 0, maxLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<GLchar> buffer(std::max(maxLength, 1));
+    for (GLint i = 0; i < numUniforms; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, i, buffer.size(), &length, &size, &type, buffer.data());
+
+        // block members have no location, arrays are reported as name[0]
+        std::string name(buffer.data(), length);
+        const GLint location = glGetUniformLocation(m_program, name.c_str());
+        if (location == -1)
+            continue;
+        if (name.ends_with("[0]"))
+            name.resize(name.size() - 3);
+        m_uniforms[name] = location;
     }
+}
 
-    return location;
+void Shader::bindUniformBlocks()
+{
+    // shared blocks have fixed binding points, glsl es 3.00 cant declare them in the source
+    if (const GLuint block = glGetUniformBlockIndex(m_program, "Camera"); block != GL_INVALID_INDEX)
+        glUniformBlockBinding(m_program, block, s_cameraBlockBinding);
 }
 
 // --------------------------------------------------
@@ -262,6 +357,74 @@ std::shared_ptr<Shader> ShaderLibrary::load(const std::string& name, const std::
     return shader;
 }
 
+void ShaderLibrary::loadEmbedded()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto elapsedMs = [](const Clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    };
+
+    const auto start = Clock::now();
+    const std::filesystem::path cacheDir = getCacheDir();
+
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+    size_t numCached = 0;
+    float savedMs = 0.0f, compileMs = 0.0f;
+    for (const auto& [name, vertSource, fragSource] : s_embeddedShaders) {
+        std::shared_ptr<Shader> shader = std::make_shared<Shader>(std::string(name));
+        const uint64_t hash = computeHash(vertSource, fragSource);
+        const std::filesystem::path file = cacheDir / (shader->getName() + ".bin");
+
+        if (float ms; numFormats > 0 && shader->loadBinary(file, hash, ms)) {
+            savedMs += ms;
+            numCached++;
+            add(shader);
+            continue;
+        }
+
+        // a rejected binary leaves the program unusable
+        shader = std::make_shared<Shader>(std::string(name));
+        const auto compileStart = Clock::now();
+        if (!shader->add(GL_VERTEX_SHADER, std::string(vertSource).c_str()) || !shader->add(GL_FRAGMENT_SHADER, std::string(fragSource).c_str()) || !shader->link()) {
+            LOG_ERROR << "Shader " << name << " failed to build";
+            continue;
+        }
+        const float ms = elapsedMs(compileStart);
+        compileMs += ms;
+
+        if (numFormats > 0 && !shader->saveBinary(file, hash, ms))
+            LOG_WARN << "Shader " << name << " could not be cached: " << file;
+        add(shader);
+    }
+
+    LOG_INFO << "Shaders: " << s_embeddedShaders.size() << " programs in " << elapsedMs(start) << " ms, " 
+             << numCached << " from the binary cache (" << savedMs << " ms of compiling saved), " 
+             << s_embeddedShaders.size() - numCached << " compiled in " << compileMs << " ms";
+}
+
+std::filesystem::path ShaderLibrary::getCacheDir()
+{
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::filesystem::path(xdg) / "RoboVis" / "shaders";
+    if (const char* home = std::getenv("HOME"); home && *home)
+        return std::filesystem::path(home) / ".cache" / "RoboVis" / "shaders";
+    return std::filesystem::temp_directory_path() / "RoboVis" / "shaders";
+}
+
+uint64_t ShaderLibrary::computeHash(const std::string_view vertSource, const std::string_view fragSource)
+{
+    uint64_t hash = hashBytes(vertSource.data(), vertSource.size());
+    hash = hashBytes(fragSource.data(), fragSource.size(), hash);
+    for (const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str)
+            hash = hashBytes(str, std::strlen(str), hash);
+    }
+    return hash;
+}
+
 std::shared_ptr<Shader> ShaderLibrary::get(const std::string& name)
 {
     assert(s_shaders.find(name) != s_shaders.end() && "shader not found");
@@ -19,6 +19,10 @@ public:
     bool addFromFile(const GLenum type, const std::filesystem::path& filePath);
     bool link();
 
+    // program binaries only load on the driver that wrote them, the hash has to cover the driver and the sources
+    bool loadBinary(const std::filesystem::path& file, const uint64_t hash, float& compileMs);
+    bool saveBinary(const std::filesystem::path& file, const uint64_t hash, const float compileMs) const;
+
     void bind() const;
     void release() const;
 
@@ -26,6 +30,19 @@ public:
     void enableAttributeArray(const GLint location);
     void setAttributeBuffer(const GLint location, const GLint size, const GLenum type, const GLboolean normalized, const GLsizei stride, const GLint offset);
 
+    // locations are reflected once at link time, -1 for uniforms the program doesnt have
+    [[nodiscard]] GLint uniformLocation(const std::string& name) const;
+
+    void uploadInt(const GLint location, const int i) const;
+    void uploadFloat(const GLint location, const float f) const;
+
+    void uploadVec2(const GLint location, const glm::vec2& vec) const;
+    void uploadVec3(const GLint location, const glm::vec3& vec) const;
+    void uploadVec4(const GLint location, const glm::vec4& vec) const;
+
+    void uploadMat3(const GLint location, const glm::mat3& mat) const;
+    void uploadMat4(const GLint location, const glm::mat4& mat) const;
+
     void uploadInt(const std::string& name, const int i) const;
     void uploadFloat(const std::string& name, const float f) const;
 
@@ -38,15 +55,23 @@ public:
 
     inline void setName(const std::string& name) { m_name = name; };
     inline const std::string& getName() const { return m_name; };
+    inline GLuint getId() const { return m_program; }
+
+    // binding point of the std140 "Camera" block, see Renderer
+    inline static constexpr GLuint s_cameraBlockBinding = 0;
 
 private:
     bool compile(const GLenum type, const GLchar* source);
-    GLint getUniformLocation(const std::string& name) const;
+    void reflectUniforms();
+    void bindUniformBlocks();
 
     std::string m_name;
     GLuint m_fragmentShader;
     GLuint m_vertexShader;
     GLuint m_program;
+
+    // missing names are added on first use, so they are reported once
+    mutable std::unordered_map<std::string, GLint> m_uniforms;
 };
 
 class ShaderLibrary
@@ -56,9 +81,15 @@ public:
     static std::shared_ptr<Shader> load(const std::string& filepath, const std::string& name = "");
     static std::shared_ptr<Shader> load(const std::string& name, const std::string& vertSource, const std::string& fragSource);
 
+    // every shader embedded at build time, linked programs come from the binary cache when possible
+    static void loadEmbedded();
+
     static std::shared_ptr<Shader> get(const std::string& name);
     inline static bool exists(const std::string& name) { return s_shaders.find(name) != s_shaders.end(); }
 
 private:
+    static std::filesystem::path getCacheDir();
+    static uint64_t computeHash(const std::string_view vertSource, const std::string_view fragSource);
+
     static std::unordered_map<std::string, std::shared_ptr<Shader>> s_shaders;
 };
\ No newline at end of file
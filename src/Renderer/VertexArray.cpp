@@ -21,6 +21,14 @@ static GLenum ShaderDataTypeToOpenGLBaseType(const ShaderDataType type)
         case ShaderDataType::Int2x2:     return GL_INT;
         case ShaderDataType::Int3x3:     return GL_INT;
         case ShaderDataType::Int4x4:     return GL_INT;
+        case ShaderDataType::Half2:      return GL_HALF_FLOAT;
+        case ShaderDataType::Half3:      return GL_HALF_FLOAT;
+        case ShaderDataType::Half4:      return GL_HALF_FLOAT;
+        case ShaderDataType::Byte2:      return GL_BYTE;
+        case ShaderDataType::Byte4:      return GL_BYTE;
+        case ShaderDataType::UByte4:     return GL_UNSIGNED_BYTE;
+        case ShaderDataType::Short3:     return GL_SHORT;
+        case ShaderDataType::UShort3:    return GL_UNSIGNED_SHORT;
         case ShaderDataType::None:       return GL_NONE;
     }
 
@@ -29,6 +37,7 @@ static GLenum ShaderDataTypeToOpenGLBaseType(const ShaderDataType type)
 }
 
 VertexArray::VertexArray()
+    : m_instanceAttributesEnabled(false)
 {
     glGenVertexArrays(1, &m_array);
 }
@@ -66,6 +75,30 @@ void VertexArray::addVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuf
     m_vertexBuffers.push_back(vertexBuffer);
 }
 
+void VertexArray::setInstanceBuffer(const VertexBuffer& instanceBuffer, const size_t offset) const
+{
+    const auto& layout = instanceBuffer.getLayout();
+    assert(!layout.getElements().empty() && "Instance buffer has no layout!");
+
+    instanceBuffer.bind();
+
+    // matrices take one location per column
+    GLuint index = s_instanceLocation;
+    for (const auto& element : layout) {
+        const size_t numColumns = element.type == ShaderDataType::Float4x4 ? 4 : (element.type == ShaderDataType::Float3x3 ? 3 : 1);
+        const size_t numRows = element.getComponentCount() / numColumns;
+        for (size_t column = 0; column < numColumns; ++column, ++index) {
+            if (!m_instanceAttributesEnabled) {
+                glEnableVertexAttribArray(index);
+                glVertexAttribDivisor(index, 1);
+            }
+            glVertexAttribPointer(  index, numRows, ShaderDataTypeToOpenGLBaseType(element.type), (GLboolean)element.normalized, 
+                                    layout.getStride(), (const void*)(offset + element.offset + column*element.size/numColumns));
+        }
+    }
+    m_instanceAttributesEnabled = true;
+}
+
 void VertexArray::setIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer)
 {
     glBindVertexArray(m_array);
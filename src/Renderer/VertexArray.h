@@ -14,11 +14,21 @@ public:
     void addVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer);
     void setIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer);
 
+    // per instance attributes from s_instanceLocation on, offset in bytes to the first instance of the next draw,
+    // the vertex array has to be bound
+    void setInstanceBuffer(const VertexBuffer& instanceBuffer, const size_t offset) const;
+
     inline const std::vector<std::shared_ptr<VertexBuffer>>& getVertexBuffers() const { return m_vertexBuffers; }
     inline const std::shared_ptr<IndexBuffer>& getIndexBuffer() const { return m_indexBuffer; }
+    inline GLuint getId() const { return m_array; }
+
+    inline static constexpr GLuint s_instanceLocation = 4;
 
 private:
     std::vector<std::shared_ptr<VertexBuffer>> m_vertexBuffers;
     std::shared_ptr<IndexBuffer> m_indexBuffer;
     uint32_t m_array;
+
+    // the instance attribute arrays and divisors are vertex array state, only the pointers move between draws
+    mutable bool m_instanceAttributesEnabled;
 };
\ No newline at end of file
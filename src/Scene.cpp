@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include "Scene.h"
+#include "Simulation.h"
 
 #include "Window/Input.h"
 
@@ -13,11 +14,14 @@
 #include "Entities/Plane.h"
 #include "Entities/Sphere.h"
 #include "Entities/Robot.h"
+#include "Entities/TrajectoryFile.h"
 
 #include "Util/geometry.h"
 
 std::shared_ptr<FrameBuffer> Scene::s_frameBuffer;
 std::unordered_map<std::string, std::shared_ptr<Entity>> Scene::s_entities;
+Frustum Scene::s_frustum;
+CullingStats Scene::s_cullingStats;
 
 void Scene::init()
 {
@@ -27,6 +31,7 @@ void Scene::init()
         height = Window::getHeight();
     }
     s_frameBuffer = std::make_shared<FrameBuffer>(width, height);
+    Renderer::init();
 
     const auto r_cam_world = angleAxisF(M_PIf32/2 + M_PIf32/8, glm::vec3(1.0f, 0.0f, 0.0f)) * angleAxisF(-M_PIf32/4, glm::vec3(0.0f, 0.0f, 1.0f));
     const auto p_cam_world = glm::vec3(2000.0f, 2000.0f, 2000.0f);
@@ -60,7 +65,6 @@ void Scene::init()
     createPlane("Plane", texture, glm::scale(glm::mat4(1.0f), {12000.0f, 12000.0f, 12000.0f}));
 
     CameraController::init(70.0f, 300.0f, 30000.0f, t_cam_world);
-    Renderer::init();
 }
 
 std::shared_ptr<Robot> Scene::createRobot(const std::string& name, const std::filesystem::path& sourceDir, const glm::mat4& initialTransformation)
@@ -71,6 +75,7 @@ std::shared_ptr<Robot> Scene::createRobot(const std::string& name, const std::fi
 
     robot->setTransformation(initialTransformation);
     addEntity(name, robot);
+    Simulation::addRobot(robot);
     return robot;
 }
 
@@ -130,6 +135,8 @@ void Scene::deleteEntity(const std::string& name)
 { 
     auto it = s_entities.find(name);
     assert(it != s_entities.end() && "Entity doesnt exist");
+    if (auto robot = dynamic_cast<Robot*>(it->second.get()); robot != nullptr)
+        Simulation::removeRobot(robot);
     s_entities.erase(it);
 }
 
@@ -137,8 +144,14 @@ void Scene::render(const Timestep dt)
 {   
     s_frameBuffer->bind();
     Renderer::clear({218.0f/256, 237.0f/256, 245.0f/256, 1.0f}); 
+    Renderer::resetUploadBudget();
     CameraController::update(dt);
 
+    const auto& camera = CameraController::getCamera();
+    Renderer::beginScene(camera);
+    s_frustum = Frustum(camera.getProjection() * camera.getView());
+    s_cullingStats = {};
+
     for (const auto&[name, entity] : s_entities) {
         if (ImGuiLayer::isViewportFocused()) {
             if (Input::isKeyPressed(GLFW_KEY_LEFT))
@@ -155,10 +168,20 @@ void Scene::render(const Timestep dt)
         }
 
         if (auto robot = dynamic_cast<Robot*>(entity.get()); robot != nullptr)
-            robot->update(dt);
+            robot->update();
+
+        // robots are tested as a whole before their links
+        if (!entity->isVisible())
+            continue;
+        s_cullingStats.entitiesTested++;
+        if (!s_frustum.intersects(entity->getBoundingBox())) {
+            s_cullingStats.entitiesCulled++;
+            continue;
+        }
 
-        entity->draw(CameraController::getCamera());
+        entity->draw(camera);
     }   
+    Renderer::endScene();
     s_frameBuffer->release();
 }
 
@@ -247,7 +270,7 @@ bool Scene::onMouseDropped(MouseDroppedEvent& e)
 
         }
         // trajectory file -> drag on specific robot control -> load trajectory for robot
-        else if (ImGuiLayer::isViewportHovered() && !std::filesystem::is_directory(path) && path.extension().string() == ".txt") {
+        else if (ImGuiLayer::isViewportHovered() && !std::filesystem::is_directory(path) && (path.extension() == ".txt" || path.extension() == TrajectoryFile::s_extension)) {
             auto robot = getEntity("robot");
             dynamic_cast<Robot*>(robot.get())->loadTrajectory(path);
         }
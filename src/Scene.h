@@ -14,6 +14,16 @@ class Plane;
 class Sphere;
 class Robot;
 
+struct CullingStats
+{
+    size_t entitiesTested;
+    size_t entitiesCulled;
+    size_t linksTested;
+    size_t linksCulled;
+    size_t meshletsTested;
+    size_t meshletsCulled;
+};
+
 class Scene
 {
 public:
@@ -38,6 +48,10 @@ public:
 
     inline static std::shared_ptr<FrameBuffer> getFrameBuffer() { return s_frameBuffer; }
 
+    // frustum of the frame being rendered, robots count their culled links and meshes their culled meshlets into the stats
+    inline static const Frustum& getFrustum() { return s_frustum; }
+    inline static CullingStats& getCullingStats() { return s_cullingStats; }
+
     static bool onMouseLeave(MouseLeaveEvent& e);
     static bool onMouseMoved(MouseMovedEvent& e);
     static bool onMouseButtonPressed(MouseButtonPressedEvent& e);
@@ -50,4 +64,7 @@ private:
     static std::shared_ptr<FrameBuffer> s_frameBuffer;
     static std::unordered_map<std::string, std::shared_ptr<Entity>> s_entities;
 
+    static Frustum s_frustum;
+    static CullingStats s_cullingStats;
+
 };
\ No newline at end of file
@@ -5,16 +5,24 @@ precision mediump int;
 precision mediump float;
 #endif
 
-uniform mat4 u_mvp;
+layout(std140) uniform Camera
+{
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_viewProjection;
+};
+
+layout(location = 0) in vec4 a_position;
+layout(location = 1) in vec4 a_color;
 
-in vec4 a_position;
-in vec4 a_color;
+// per instance
+layout(location = 4) in mat4 a_model;
 
 out vec4 v_color;
 
 void main()
 {
-    gl_Position = u_mvp * a_position;
+    gl_Position = u_viewProjection * a_model * a_position;
 
     v_color = a_color;
 }
\ No newline at end of file
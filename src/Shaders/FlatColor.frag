@@ -5,11 +5,11 @@ precision mediump int;
 precision mediump float;
 #endif
 
-uniform vec4 u_color;
+in vec4 v_color;
 
 out vec4 color;
 
 void main()
 {
-    color = u_color;
+    color = v_color;
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 300 es
+
+#ifdef GL_ES
+precision mediump int;
+precision mediump float;
+#endif
+
+in vec3 v_normal;
+in vec4 v_color;
+
+out vec4 fragColor;
+
+void main()
+{
+    // headlight, the camera looks along -z in view space
+    float diffuse = abs(normalize(v_normal).z);
+    fragColor = vec4(v_color.rgb * (0.4 + 0.6*diffuse), v_color.a);
+}
\ No newline at end of file
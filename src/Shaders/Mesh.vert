@@ -0,0 +1,44 @@
+#version 300 es
+
+#ifdef GL_ES
+precision mediump int;
+precision mediump float;
+#endif
+
+layout(std140) uniform Camera
+{
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_viewProjection;
+};
+
+layout(location = 0) in vec4 a_position;
+layout(location = 1) in vec2 a_normal;
+
+// per instance, the quantized position is mapped into mesh space before the model
+layout(location = 4) in mat4 a_model;
+layout(location = 8) in vec4 a_color;
+layout(location = 9) in vec4 a_positionScale;
+layout(location = 10) in vec4 a_positionOffset;
+
+out vec3 v_normal;
+out vec4 v_color;
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main()
+{
+    gl_Position = u_viewProjection * a_model * (a_positionScale * a_position + a_positionOffset);
+
+    // cofactor matrix, the inverse transpose up to scale, normals are stored in mesh space
+    mat3 m = mat3(a_model);
+    mat3 normalMatrix = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+    v_normal = mat3(u_view) * normalMatrix * octDecode(a_normal);
+    v_color = a_color;
+}
\ No newline at end of file
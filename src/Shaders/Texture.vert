@@ -3,15 +3,23 @@
 precision mediump int;
 precision mediump float;
 
-uniform mat4 u_mvp;
+layout(std140) uniform Camera
+{
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_viewProjection;
+};
+
+layout(location = 0) in vec4 a_position;
+layout(location = 1) in vec2 a_texCoord;
 
-in vec4 a_position;
-in vec2 a_texCoord;
+// per instance
+layout(location = 4) in mat4 a_model;
 
 out vec2 v_texCoord;
 
 void main()
 {
     v_texCoord = a_texCoord;
-    gl_Position = u_mvp * a_position;           
+    gl_Position = u_viewProjection * a_model * a_position;
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include "Simulation.h"
+
+#include "Entities/Robot.h"
+
+#include "Util/Log.h"
+
+std::jthread Simulation::s_thread;
+std::mutex Simulation::s_mutex;
+std::vector<std::shared_ptr<Robot>> Simulation::s_robots;
+std::chrono::steady_clock::time_point Simulation::s_start = std::chrono::steady_clock::now();
+std::atomic<uint64_t> Simulation::s_steps = 0;
+std::atomic<uint64_t> Simulation::s_stepsDropped = 0;
+std::atomic<float> Simulation::s_stepTimeMs = 0.0f;
+
+void Simulation::start()
+{
+    assert(!s_thread.joinable() && "Simulation is already running");
+
+    s_start = std::chrono::steady_clock::now();
+    s_steps = 0;
+    s_stepsDropped = 0;
+    s_thread = std::jthread(run);
+
+    LOG_INFO << "Simulation running at " << 1.0/s_step << " Hz";
+}
+
+void Simulation::stop()
+{
+    s_thread.request_stop();
+    if (s_thread.joinable())
+        s_thread.join();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_robots.clear();
+}
+
+void Simulation::addRobot(const std::shared_ptr<Robot>& robot)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_robots.push_back(robot);
+}
+
+void Simulation::removeRobot(const Robot* robot)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::erase_if(s_robots, [robot](const std::shared_ptr<Robot>& r) { return r.get() == robot; });
+}
+
+double Simulation::now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+SimulationStats Simulation::getStats()
+{
+    return { s_steps.load(std::memory_order_relaxed), s_stepsDropped.load(std::memory_order_relaxed), s_stepTimeMs.load(std::memory_order_relaxed) };
+}
+
+void Simulation::run(const std::stop_token& token)
+{
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(s_step));
+
+    // step n simulates the interval ending at n*s_step, dropped steps still advance the clock
+    uint64_t step = 0;
+    auto next = s_start;
+    while (!token.stop_requested()) {
+        const auto begin = clock::now();
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            const double time = (step + 1)*s_step;
+            for (const auto& robot : s_robots)
+                robot->step(time, static_cast<float>(s_step));
+        }
+        const auto end = clock::now();
+
+        step++;
+        s_steps.fetch_add(1, std::memory_order_relaxed);
+        s_stepTimeMs.store(std::chrono::duration<float, std::milli>(end - begin).count(), std::memory_order_relaxed);
+
+        next += period;
+        if (end - next > s_maxLag) {
+            const uint64_t dropped = (end - next)/period;
+            step += dropped;
+            next += dropped*period;
+            s_stepsDropped.fetch_add(dropped, std::memory_order_relaxed);
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Timestep.h"
+
+class Robot;
+
+struct SimulationStats
+{
+    uint64_t steps;
+    uint64_t stepsDropped;
+    float stepTimeMs;
+};
+
+// advances all robots at a fixed rate on its own thread, the render thread only reads
+// the link transforms the robots publish after every step
+class Simulation
+{
+public:
+    static void start();
+    static void stop();
+
+    static void addRobot(const std::shared_ptr<Robot>& robot);
+    static void removeRobot(const Robot* robot);
+
+    // seconds on the simulation clock, snapshot times are on the same clock
+    static double now();
+
+    static SimulationStats getStats();
+
+    // 1 kHz, the rate of the robot controllers
+    inline static constexpr double s_step = 0.001;
+
+private:
+    static void run(const std::stop_token& token);
+
+    static std::jthread s_thread;
+    static std::mutex s_mutex;
+    static std::vector<std::shared_ptr<Robot>> s_robots;
+    static std::chrono::steady_clock::time_point s_start;
+
+    static std::atomic<uint64_t> s_steps;
+    static std::atomic<uint64_t> s_stepsDropped;
+    static std::atomic<float> s_stepTimeMs;
+
+    // further behind than this the missed steps are dropped instead of caught up
+    inline static constexpr std::chrono::milliseconds s_maxLag = std::chrono::milliseconds(50);
+
+};
@@ -0,0 +1,264 @@
+#include "pch.h"
+
+#include "Bvh.h"
+
+#include "geometry.h"
+
+void Bvh::Bounds::grow(const glm::vec3& p)
+{
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+}
+
+void Bvh::Bounds::grow(const Bounds& b)
+{
+    min = glm::min(min, b.min);
+    max = glm::max(max, b.max);
+}
+
+float Bvh::Bounds::area() const
+{
+    const auto e = max - min;
+    return e.x*e.y + e.y*e.z + e.z*e.x;
+}
+
+void Bvh::build(const std::vector<std::array<glm::vec3, 3>>& triangles)
+{
+    clear();
+    if (triangles.empty())
+        return;
+
+    const uint32_t numTriangles = static_cast<uint32_t>(triangles.size());
+
+    std::vector<Bounds> triBounds(numTriangles);
+    std::vector<glm::vec3> centroids(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        for (const auto& p : triangles[i])
+            triBounds[i].grow(p);
+        centroids[i] = (triangles[i][0] + triangles[i][1] + triangles[i][2]) / 3.0f;
+    }
+
+    m_triIndices.resize(numTriangles);
+    std::iota(m_triIndices.begin(), m_triIndices.end(), 0);
+
+    m_ownedNodes.reserve(2*numTriangles - 1);
+    m_ownedNodes.push_back(BvhNode{ .boundsMin = glm::vec3(0.0f), .leftFirst = 0, .boundsMax = glm::vec3(0.0f), .count = numTriangles });
+    updateNodeBounds(m_ownedNodes.front(), triBounds);
+
+    // iterative build, stack holds (node, depth)
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(0, 1);
+    while (!stack.empty()) {
+        const auto [nodeIdx, depth] = stack.back();
+        stack.pop_back();
+
+        if (depth >= s_maxStackDepth)
+            continue;
+
+        subdivide(nodeIdx, triBounds, centroids);
+
+        const auto& node = m_ownedNodes[nodeIdx];
+        if (!node.isLeaf()) {
+            stack.emplace_back(node.leftFirst, depth + 1);
+            stack.emplace_back(node.leftFirst + 1, depth + 1);
+        }
+    }
+
+    // store triangles in leaf order so each leaf reads a contiguous range
+    m_ownedTriangles.resize(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i)
+        m_ownedTriangles[i] = triangles[m_triIndices[i]];
+
+    m_triIndices.clear();
+    m_triIndices.shrink_to_fit();
+    m_ownedNodes.shrink_to_fit();
+
+    m_nodes = m_ownedNodes;
+    m_triangles = m_ownedTriangles;
+}
+
+void Bvh::view(const std::span<const BvhNode> nodes, const std::span<const std::array<glm::vec3, 3>> triangles)
+{
+    clear();
+    m_nodes = nodes;
+    m_triangles = triangles;
+}
+
+void Bvh::clear()
+{
+    m_nodes = {};
+    m_triangles = {};
+    m_ownedNodes.clear();
+    m_triIndices.clear();
+    m_ownedTriangles.clear();
+}
+
+bool Bvh::intersect(const glm::vec3& p_ray, const glm::vec3& v_ray, float& t_hit) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    const glm::vec3 v_rayInv(1.0f / v_ray.x, 1.0f / v_ray.y, 1.0f / v_ray.z);
+    constexpr float miss = std::numeric_limits<float>::max();
+
+    t_hit = miss;
+    if (intersectionRayAabb(p_ray, v_rayInv, m_nodes[0].boundsMin, m_nodes[0].boundsMax, t_hit) == miss)
+        return false;
+
+    std::array<const BvhNode*, s_maxStackDepth> stack;
+    size_t stackSize = 0;
+    const BvhNode* node = &m_nodes[0];
+    while (true) {
+        if (node->isLeaf()) {
+            for (uint32_t i = 0; i < node->count; ++i) {
+                float t;
+                if (intersectionRayTriangle(p_ray, v_ray, m_triangles[node->leftFirst + i], t) && t < t_hit)
+                    t_hit = t;
+            }
+
+            if (stackSize == 0)
+                break;
+            node = stack[--stackSize];
+            continue;
+        }
+
+        const BvhNode* near = &m_nodes[node->leftFirst];
+        const BvhNode* far = &m_nodes[node->leftFirst + 1];
+        float dNear = intersectionRayAabb(p_ray, v_rayInv, near->boundsMin, near->boundsMax, t_hit);
+        float dFar = intersectionRayAabb(p_ray, v_rayInv, far->boundsMin, far->boundsMax, t_hit);
+        if (dNear > dFar) {
+            std::swap(dNear, dFar);
+            std::swap(near, far);
+        }
+
+        if (dNear == miss) {
+            if (stackSize == 0)
+                break;
+            node = stack[--stackSize];
+        }
+        else {
+            node = near;
+            if (dFar != miss)
+                stack[stackSize++] = far;
+        }
+    }
+
+    return t_hit != miss;
+}
+
+void Bvh::updateNodeBounds(BvhNode& node, const std::vector<Bounds>& triBounds) const
+{
+    Bounds bounds;
+    for (uint32_t i = 0; i < node.count; ++i)
+        bounds.grow(triBounds[m_triIndices[node.leftFirst + i]]);
+
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+}
+
+void Bvh::subdivide(const uint32_t nodeIdx, const std::vector<Bounds>& triBounds, const std::vector<glm::vec3>& centroids)
+{
+    BvhNode& node = m_ownedNodes[nodeIdx];
+    if (node.count <= 1)
+        return;
+
+    int axis;
+    float splitPos;
+    const float splitCost = findBestSplit(node, triBounds, centroids, axis, splitPos);
+
+    if (axis < 0)
+        return;
+
+    // sah, a traversal step is weighted like one triangle test
+    const Bounds nodeBounds{ node.boundsMin, node.boundsMax };
+    const float nodeArea = nodeBounds.area();
+    if (node.count <= s_maxLeafSize && nodeArea + splitCost >= node.count*nodeArea)
+        return;
+
+    // partition triangle indices by centroid
+    int64_t i = node.leftFirst;
+    int64_t j = i + node.count - 1;
+    while (i <= j) {
+        if (centroids[m_triIndices[i]][axis] < splitPos)
+            i++;
+        else
+            std::swap(m_triIndices[i], m_triIndices[j--]);
+    }
+
+    const uint32_t leftCount = static_cast<uint32_t>(i - node.leftFirst);
+    if (leftCount == 0 || leftCount == node.count)
+        return;
+
+    const uint32_t leftIdx = static_cast<uint32_t>(m_ownedNodes.size());
+    m_ownedNodes.push_back(BvhNode{ .boundsMin = glm::vec3(0.0f), .leftFirst = node.leftFirst, .boundsMax = glm::vec3(0.0f), .count = leftCount });
+    m_ownedNodes.push_back(BvhNode{ .boundsMin = glm::vec3(0.0f), .leftFirst = static_cast<uint32_t>(i), .boundsMax = glm::vec3(0.0f), .count = node.count - leftCount });
+
+    // node reference stays valid, nodes were reserved up front
+    node.leftFirst = leftIdx;
+    node.count = 0;
+
+    updateNodeBounds(m_ownedNodes[leftIdx], triBounds);
+    updateNodeBounds(m_ownedNodes[leftIdx + 1], triBounds);
+}
+
+float Bvh::findBestSplit(const BvhNode& node, const std::vector<Bounds>& triBounds, const std::vector<glm::vec3>& centroids, int& axis, float& splitPos) const
+{
+    struct Bin
+    {
+        Bounds bounds;
+        uint32_t count = 0;
+    };
+
+    float bestCost = std::numeric_limits<float>::max();
+    axis = -1;
+
+    for (int a = 0; a < 3; ++a) {
+        float centroidMin = std::numeric_limits<float>::max();
+        float centroidMax = std::numeric_limits<float>::lowest();
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const float c = centroids[m_triIndices[node.leftFirst + i]][a];
+            centroidMin = std::min(centroidMin, c);
+            centroidMax = std::max(centroidMax, c);
+        }
+        if (centroidMin == centroidMax)
+            continue;
+
+        std::array<Bin, s_numBins> bins;
+        const float scale = s_numBins / (centroidMax - centroidMin);
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const uint32_t triIdx = m_triIndices[node.leftFirst + i];
+            const uint32_t binIdx = std::min(s_numBins - 1, static_cast<uint32_t>((centroids[triIdx][a] - centroidMin) * scale));
+            bins[binIdx].count++;
+            bins[binIdx].bounds.grow(triBounds[triIdx]);
+        }
+
+        // sweep bins from both sides to get the cost of every plane in O(bins)
+        std::array<float, s_numBins - 1> leftArea, rightArea;
+        std::array<uint32_t, s_numBins - 1> leftCount, rightCount;
+        Bounds leftBounds, rightBounds;
+        uint32_t leftSum = 0, rightSum = 0;
+        for (uint32_t i = 0; i < s_numBins - 1; ++i) {
+            leftSum += bins[i].count;
+            leftCount[i] = leftSum;
+            leftBounds.grow(bins[i].bounds);
+            leftArea[i] = leftSum > 0 ? leftBounds.area() : 0.0f;
+
+            rightSum += bins[s_numBins - 1 - i].count;
+            rightCount[s_numBins - 2 - i] = rightSum;
+            rightBounds.grow(bins[s_numBins - 1 - i].bounds);
+            rightArea[s_numBins - 2 - i] = rightSum > 0 ? rightBounds.area() : 0.0f;
+        }
+
+        const float binWidth = (centroidMax - centroidMin) / s_numBins;
+        for (uint32_t i = 0; i < s_numBins - 1; ++i) {
+            const float cost = leftCount[i]*leftArea[i] + rightCount[i]*rightArea[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                axis = a;
+                splitPos = centroidMin + binWidth*(i + 1);
+            }
+        }
+    }
+
+    return bestCost;
+}
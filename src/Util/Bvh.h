@@ -0,0 +1,65 @@
+#pragma once
+
+struct BvhNode
+{
+    glm::vec3 boundsMin;
+    uint32_t leftFirst;
+    glm::vec3 boundsMax;
+    uint32_t count;
+
+    inline bool isLeaf() const { return count > 0; }
+};
+
+class Bvh
+{
+public:
+    Bvh() = default;
+    ~Bvh() = default;
+
+    // the views point into the owned storage, moving keeps it in place
+    Bvh(const Bvh&) = delete;
+    Bvh& operator=(const Bvh&) = delete;
+    Bvh(Bvh&&) = default;
+    Bvh& operator=(Bvh&&) = default;
+
+    void build(const std::vector<std::array<glm::vec3, 3>>& triangles);
+
+    // nodes and triangles laid out like getNodes() and getTriangles(), the caller keeps them alive
+    void view(const std::span<const BvhNode> nodes, const std::span<const std::array<glm::vec3, 3>> triangles);
+    void clear();
+
+    bool intersect(const glm::vec3& p_ray, const glm::vec3& v_ray, float& t_hit) const;
+
+    inline bool empty() const { return m_nodes.empty(); }
+    inline size_t numNodes() const { return m_nodes.size(); }
+    inline size_t numTriangles() const { return m_triangles.size(); }
+    inline std::span<const BvhNode> getNodes() const { return m_nodes; }
+    inline std::span<const std::array<glm::vec3, 3>> getTriangles() const { return m_triangles; }
+
+private:
+    struct Bounds
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        void grow(const glm::vec3& p);
+        void grow(const Bounds& b);
+        float area() const;
+    };
+
+    void updateNodeBounds(BvhNode& node, const std::vector<Bounds>& triBounds) const;
+    void subdivide(const uint32_t nodeIdx, const std::vector<Bounds>& triBounds, const std::vector<glm::vec3>& centroids);
+    float findBestSplit(const BvhNode& node, const std::vector<Bounds>& triBounds, const std::vector<glm::vec3>& centroids, int& axis, float& splitPos) const;
+
+    std::span<const BvhNode> m_nodes;
+    std::span<const std::array<glm::vec3, 3>> m_triangles;
+
+    // storage of built hierarchies, views leave it empty
+    std::vector<BvhNode> m_ownedNodes;
+    std::vector<uint32_t> m_triIndices;
+    std::vector<std::array<glm::vec3, 3>> m_ownedTriangles;
+
+    inline static constexpr uint32_t s_numBins = 12;
+    inline static constexpr uint32_t s_maxLeafSize = 4;
+    inline static constexpr uint32_t s_maxStackDepth = 64;
+};
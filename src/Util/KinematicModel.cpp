@@ -0,0 +1,168 @@
+#include "pch.h"
+
+#include "KinematicModel.h"
+
+#include "Log.h"
+#include "simd.h"
+
+// same matrix as angleAxisF, the axis is normalized once in build()
+static glm::mat4 rotation(const float angle, const glm::vec3& v_axis)
+{
+    const float c = cosf(angle);
+    const float s = sinf(angle);
+    const float t1 = 1.0f - c;
+    const auto& [x, y, z] = v_axis;
+    return glm::mat4(
+        c + x*x*t1  , x*y*t1 - z*s, x*z*t1 + y*s, 0.0f,
+        y*x*t1 + z*s, c + y*y*t1  , y*z*t1 - x*s, 0.0f,
+        z*x*t1 - y*s, z*y*t1 + x*s, c + z*z*t1  , 0.0f,
+        0.0f        , 0.0f        , 0.0f        , 1.0f
+    );
+}
+
+void KinematicModel::build(const size_t numLinks, const std::vector<KinematicJoint>& joints)
+{
+    clear();
+    m_numLinks = numLinks;
+
+    std::vector<bool> isChild(numLinks, false);
+    for (const auto& joint : joints)
+        isChild[joint.child] = true;
+    for (uint32_t link = 0; link < numLinks; ++link)
+        if (!isChild[link])
+            m_roots.push_back(link);
+
+    // repeated passes keep the urdf order between joints of the same depth
+    std::vector<bool> placed(numLinks, false);
+    for (const uint32_t root : m_roots)
+        placed[root] = true;
+
+    std::vector<bool> added(joints.size(), false);
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (size_t i = 0; i < joints.size(); ++i) {
+            const auto& joint = joints[i];
+            if (added[i] || !placed[joint.parent])
+                continue;
+
+            m_parents.push_back(joint.parent);
+            m_children.push_back(joint.child);
+            m_valueIndices.push_back(static_cast<uint32_t>(i));
+            m_parentToChild.push_back(joint.parentToChild);
+            m_axes.push_back(glm::normalize(joint.rotationAxis));
+
+            placed[joint.child] = true;
+            added[i] = progress = true;
+        }
+    }
+
+    if (numJoints() != joints.size())
+        LOG_WARN << "Kinematic chain contains a loop, " << joints.size() - numJoints() << " joints ignored";
+}
+
+void KinematicModel::clear()
+{
+    m_numLinks = 0;
+    m_parents.clear();
+    m_children.clear();
+    m_valueIndices.clear();
+    m_parentToChild.clear();
+    m_axes.clear();
+    m_roots.clear();
+}
+
+void KinematicModel::evaluate(const std::span<const float> jointValues, const glm::mat4& t_base_world, const std::span<glm::mat4> t_link_world) const
+{
+    assert(t_link_world.size() >= m_numLinks && "Output too small for the kinematic model");
+
+    for (const uint32_t root : m_roots)
+        t_link_world[root] = t_base_world;
+
+    for (size_t i = 0; i < numJoints(); ++i)
+        t_link_world[m_children[i]] = rotation(jointValues[m_valueIndices[i]], m_axes[i]) * m_parentToChild[i] * t_link_world[m_parents[i]];
+}
+
+void KinematicModel::evaluate(const std::span<const float> jointValues, const size_t numConfigs, const glm::mat4& t_base_world, const std::span<glm::mat4> t_link_world) const
+{
+    assert(jointValues.size() >= numJoints()*numConfigs && "Too few joint values for the kinematic model");
+    assert(t_link_world.size() >= m_numLinks*numConfigs && "Output too small for the kinematic model");
+
+    // all transforms are affine with the translation in row 3, so only columns 0-2 are carried,
+    // component col*4 + row holds one value per configuration
+    using Affine = std::array<SimdFloat, 12>;
+    constexpr size_t width = SimdFloat::s_width;
+
+    Affine t_base;
+    for (size_t col = 0; col < 3; ++col)
+        for (size_t row = 0; row < 4; ++row)
+            t_base[col*4 + row] = SimdFloat::broadcast(t_base_world[col][row]);
+
+    std::vector<Affine> t_world(m_numLinks);
+    std::array<float, width> lanes;
+    std::array<std::array<float, width>, 12> components;
+
+    for (size_t first = 0; first < numConfigs; first += width) {
+        const size_t count = std::min(width, numConfigs - first);
+
+        for (const uint32_t root : m_roots)
+            t_world[root] = t_base;
+
+        for (size_t i = 0; i < numJoints(); ++i) {
+            const float* values = jointValues.data() + m_valueIndices[i]*numConfigs + first;
+            if (count < width) {
+                lanes.fill(0.0f);
+                std::copy_n(values, count, lanes.begin());
+                values = lanes.data();
+            }
+
+            SimdFloat s, c;
+            simdSinCos(SimdFloat::load(values), s, c);
+
+            // rotation[k][row] = a_k*a_row + c*(delta - a_k*a_row) + s*[a]x, same layout as angleAxisF
+            const auto& a = m_axes[i];
+            const std::array<float, 9> skew = { 0.0f, -a.z, a.y, a.z, 0.0f, -a.x, -a.y, a.x, 0.0f };
+            std::array<SimdFloat, 9> r;
+            for (size_t k = 0; k < 3; ++k)
+                for (size_t row = 0; row < 3; ++row) {
+                    const float aa = a[k]*a[row];
+                    r[k*3 + row] = SimdFloat::fma(c, SimdFloat::broadcast((k == row ? 1.0f : 0.0f) - aa), SimdFloat::fma(s, SimdFloat::broadcast(skew[k*3 + row]), SimdFloat::broadcast(aa)));
+                }
+
+            // parentToChild * t_parent_world, the fixed part is the same for all lanes
+            const auto& p = m_parentToChild[i];
+            const Affine& t_parent = t_world[m_parents[i]];
+            Affine t_fixed;
+            for (size_t col = 0; col < 3; ++col)
+                for (size_t row = 0; row < 4; ++row) {
+                    SimdFloat sum = row == 3 ? t_parent[col*4 + 3] : SimdFloat::broadcast(0.0f);
+                    for (size_t k = 0; k < 3; ++k)
+                        sum = SimdFloat::fma(SimdFloat::broadcast(p[k][row]), t_parent[col*4 + k], sum);
+                    t_fixed[col*4 + row] = sum;
+                }
+
+            // the rotation leaves row 3 alone
+            Affine& t_child = t_world[m_children[i]];
+            for (size_t col = 0; col < 3; ++col) {
+                for (size_t row = 0; row < 3; ++row) {
+                    SimdFloat sum = r[row]*t_fixed[col*4];
+                    sum = SimdFloat::fma(r[3 + row], t_fixed[col*4 + 1], sum);
+                    t_child[col*4 + row] = SimdFloat::fma(r[6 + row], t_fixed[col*4 + 2], sum);
+                }
+                t_child[col*4 + 3] = t_fixed[col*4 + 3];
+            }
+        }
+
+        for (size_t link = 0; link < m_numLinks; ++link) {
+            for (size_t j = 0; j < 12; ++j)
+                t_world[link][j].store(components[j].data());
+
+            for (size_t lane = 0; lane < count; ++lane) {
+                glm::mat4& t = t_link_world[(first + lane)*m_numLinks + link];
+                for (size_t col = 0; col < 3; ++col)
+                    for (size_t row = 0; row < 4; ++row)
+                        t[col][row] = components[col*4 + row][lane];
+                t[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+struct KinematicJoint
+{
+    uint32_t parent;
+    uint32_t child;
+    glm::mat4 parentToChild;
+    glm::vec3 rotationAxis;
+};
+
+// flattened kinematic tree, joints are sorted so every parent link is evaluated before its children
+class KinematicModel
+{
+public:
+    KinematicModel() = default;
+    ~KinematicModel() = default;
+
+    // joints index links, joint values keep the order of the given joints
+    void build(const size_t numLinks, const std::vector<KinematicJoint>& joints);
+    void clear();
+
+    void evaluate(const std::span<const float> jointValues, const glm::mat4& t_base_world, const std::span<glm::mat4> t_link_world) const;
+
+    // batched over configurations, jointValues holds numConfigs values per joint (joint major),
+    // t_link_world receives numLinks transforms per configuration (configuration major)
+    void evaluate(const std::span<const float> jointValues, const size_t numConfigs, const glm::mat4& t_base_world, const std::span<glm::mat4> t_link_world) const;
+
+    inline size_t numLinks() const { return m_numLinks; }
+    inline size_t numJoints() const { return m_parents.size(); }
+
+    // in evaluation order
+    inline const std::vector<uint32_t>& getParents() const { return m_parents; }
+    inline const std::vector<uint32_t>& getChildren() const { return m_children; }
+    inline const std::vector<uint32_t>& getValueIndices() const { return m_valueIndices; }
+    inline const std::vector<glm::mat4>& getParentToChild() const { return m_parentToChild; }
+    inline const std::vector<glm::vec3>& getAxes() const { return m_axes; }
+    inline const std::vector<uint32_t>& getRoots() const { return m_roots; }
+
+private:
+    size_t m_numLinks = 0;
+
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_children;
+    std::vector<uint32_t> m_valueIndices;
+    std::vector<glm::mat4> m_parentToChild;
+    std::vector<glm::vec3> m_axes;
+
+    // links no joint moves, they follow the base
+    std::vector<uint32_t> m_roots;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+class MappedFile
+{
+public:
+    MappedFile(const std::filesystem::path& file);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool isOpen() const { return m_data != nullptr; }
+    inline const char* data() const { return m_data; }
+    inline size_t size() const { return m_size; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+
+};
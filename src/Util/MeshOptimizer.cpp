@@ -0,0 +1,483 @@
+#include "pch.h"
+
+#include "MeshOptimizer.h"
+
+static constexpr uint32_t s_none = std::numeric_limits<uint32_t>::max();
+
+void MeshOptimizer::optimize(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices, MeshOptimizerStats& stats)
+{
+    stats.numVerticesBefore += positions.size();
+    stats.numTrianglesBefore += indices.size();
+    stats.cacheMissesBefore += cacheMisses(indices, positions.size());
+
+    glm::vec3 p_min(std::numeric_limits<float>::max()), p_max(std::numeric_limits<float>::lowest());
+    for (const auto& p : positions) {
+        p_min = glm::min(p_min, p);
+        p_max = glm::max(p_max, p);
+    }
+    const float diagonal = positions.empty() ? 0.0f : glm::length(p_max - p_min);
+
+    weld(positions, normals, indices, std::max(s_weldEpsilon*diagonal, 1e-6f));
+    removeDegenerates(indices);
+    optimizeVertexCache(indices, positions.size());
+    optimizeVertexFetch(positions, normals, indices);
+
+    stats.numVerticesAfter += positions.size();
+    stats.numTrianglesAfter += indices.size();
+    stats.cacheMissesAfter += cacheMisses(indices, positions.size());
+}
+
+void MeshOptimizer::weld(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices, const float epsilon, const float creaseCos)
+{
+    assert(positions.size() == normals.size() && "Every vertex needs a normal");
+
+    // hash grid with cells of size epsilon, a match is always in one of the 27 surrounding cells
+    const auto cellKey = [](const int64_t x, const int64_t y, const int64_t z) {
+        return static_cast<uint64_t>(x*73856093) ^ static_cast<uint64_t>(y*19349663) ^ static_cast<uint64_t>(z*83492791);
+    };
+
+    std::unordered_map<uint64_t, uint32_t> heads;
+    heads.reserve(positions.size());
+    std::vector<uint32_t> next;
+    std::vector<glm::vec3> welded, normalSums, firstNormals;
+    std::vector<uint32_t> remap(positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const glm::vec3& p = positions[i];
+        const glm::vec3& n = normals[i];
+        const int64_t x = static_cast<int64_t>(std::floor(p.x / epsilon));
+        const int64_t y = static_cast<int64_t>(std::floor(p.y / epsilon));
+        const int64_t z = static_cast<int64_t>(std::floor(p.z / epsilon));
+
+        // different cells may share a bucket, the distance test sorts that out
+        uint32_t match = s_none;
+        for (int64_t dx = -1; dx <= 1 && match == s_none; ++dx)
+            for (int64_t dy = -1; dy <= 1 && match == s_none; ++dy)
+                for (int64_t dz = -1; dz <= 1 && match == s_none; ++dz) {
+                    const auto it = heads.find(cellKey(x + dx, y + dy, z + dz));
+                    if (it == heads.end())
+                        continue;
+
+                    for (uint32_t j = it->second; j != s_none; j = next[j]) {
+                        const glm::vec3 d = welded[j] - p;
+                        if (glm::dot(d, d) <= epsilon*epsilon && glm::dot(firstNormals[j], n) >= creaseCos) {
+                            match = j;
+                            break;
+                        }
+                    }
+                }
+
+        if (match == s_none) {
+            match = static_cast<uint32_t>(welded.size());
+            welded.push_back(p);
+            normalSums.push_back(n);
+            firstNormals.push_back(n);
+
+            auto [it, inserted] = heads.try_emplace(cellKey(x, y, z), s_none);
+            next.push_back(it->second);
+            it->second = match;
+        }
+        else
+            normalSums[match] += n;
+
+        remap[i] = match;
+    }
+
+    for (size_t i = 0; i < welded.size(); ++i)
+        if (glm::length(normalSums[i]) > 0.0f)
+            normalSums[i] = glm::normalize(normalSums[i]);
+        else
+            normalSums[i] = firstNormals[i];
+
+    for (auto& triangle : indices)
+        for (auto& index : triangle)
+            index = remap[index];
+
+    positions = std::move(welded);
+    normals = std::move(normalSums);
+}
+
+void MeshOptimizer::removeDegenerates(std::vector<std::array<uint32_t, 3>>& indices)
+{
+    std::erase_if(indices, [](const std::array<uint32_t, 3>& triangle) {
+        return triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2];
+    });
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<std::array<uint32_t, 3>>& indices, const size_t numVertices)
+{
+    const size_t numTriangles = indices.size();
+    if (numTriangles == 0)
+        return;
+
+    // vertices recently used score high, vertices with few triangles left even higher so they are finished off
+    const auto vertexScore = [](const int cachePos, const uint32_t numRemaining) {
+        if (numRemaining == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePos >= 0)
+            score = cachePos < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(cachePos - 3) / (s_cacheSize - 3), 1.5f);
+        return score + 2.0f / std::sqrt(static_cast<float>(numRemaining));
+    };
+
+    // triangles per vertex, the first numRemaining entries of each range are not emitted yet
+    std::vector<uint32_t> numRemaining(numVertices, 0);
+    for (const auto& triangle : indices)
+        for (const uint32_t index : triangle)
+            numRemaining[index]++;
+
+    std::vector<uint32_t> offsets(numVertices + 1, 0);
+    for (size_t v = 0; v < numVertices; ++v)
+        offsets[v + 1] = offsets[v] + numRemaining[v];
+
+    std::vector<uint32_t> adjacency(offsets.back());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t t = 0; t < numTriangles; ++t)
+        for (const uint32_t index : indices[t])
+            adjacency[fill[index]++] = t;
+
+    std::vector<int> cachePos(numVertices, -1);
+    std::vector<float> scores(numVertices);
+    for (size_t v = 0; v < numVertices; ++v)
+        scores[v] = vertexScore(-1, numRemaining[v]);
+
+    std::vector<bool> emitted(numTriangles, false);
+    std::vector<std::array<uint32_t, 3>> result;
+    result.reserve(numTriangles);
+
+    std::array<uint32_t, s_cacheSize + 3> cache, newCache;
+    size_t cacheCount = 0;
+    size_t cursor = 0;
+    uint32_t best = s_none;
+
+    while (result.size() < numTriangles) {
+        // nothing left around the cache, continue with the next triangle in input order
+        if (best == s_none) {
+            while (emitted[cursor])
+                cursor++;
+            best = static_cast<uint32_t>(cursor);
+        }
+
+        const auto& triangle = indices[best];
+        emitted[best] = true;
+        result.push_back(triangle);
+
+        for (const uint32_t index : triangle) {
+            const auto begin = adjacency.begin() + offsets[index];
+            const auto end = begin + numRemaining[index];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            numRemaining[index]--;
+        }
+
+        // the emitted vertices move to the front, the rest keeps its order
+        size_t newCount = 0;
+        for (const uint32_t index : triangle)
+            newCache[newCount++] = index;
+        for (size_t i = 0; i < cacheCount; ++i)
+            if (std::find(triangle.begin(), triangle.end(), cache[i]) == triangle.end())
+                newCache[newCount++] = cache[i];
+
+        for (size_t i = s_cacheSize; i < newCount; ++i) {
+            cachePos[newCache[i]] = -1;
+            scores[newCache[i]] = vertexScore(-1, numRemaining[newCache[i]]);
+        }
+
+        cacheCount = std::min(newCount, s_cacheSize);
+        std::copy_n(newCache.begin(), cacheCount, cache.begin());
+        for (size_t i = 0; i < cacheCount; ++i) {
+            cachePos[cache[i]] = static_cast<int>(i);
+            scores[cache[i]] = vertexScore(static_cast<int>(i), numRemaining[cache[i]]);
+        }
+
+        // only triangles touching the cache changed their score
+        best = s_none;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            for (uint32_t j = offsets[v]; j < offsets[v] + numRemaining[v]; ++j) {
+                const uint32_t t = adjacency[j];
+                const auto& candidate = indices[t];
+                const float score = scores[candidate[0]] + scores[candidate[1]] + scores[candidate[2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices = std::move(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices)
+{
+    std::vector<uint32_t> remap(positions.size(), s_none);
+    uint32_t numUsed = 0;
+    for (auto& triangle : indices)
+        for (auto& index : triangle) {
+            if (remap[index] == s_none)
+                remap[index] = numUsed++;
+            index = remap[index];
+        }
+
+    std::vector<glm::vec3> reorderedPositions(numUsed), reorderedNormals(numUsed);
+    for (size_t i = 0; i < positions.size(); ++i)
+        if (remap[i] != s_none) {
+            reorderedPositions[remap[i]] = positions[i];
+            reorderedNormals[remap[i]] = normals[i];
+        }
+
+    positions = std::move(reorderedPositions);
+    normals = std::move(reorderedNormals);
+}
+
+MeshOptimizer::Quadric::Quadric(const glm::vec3& n, const float d, const double w)
+    : a00(w*n.x*n.x), a01(w*n.x*n.y), a02(w*n.x*n.z), a11(w*n.y*n.y), a12(w*n.y*n.z), a22(w*n.z*n.z),
+      b0(w*n.x*d), b1(w*n.y*d), b2(w*n.z*d), c(w*d*d), weight(w)
+{
+}
+
+MeshOptimizer::Quadric& MeshOptimizer::Quadric::operator+=(const Quadric& q)
+{
+    a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+    b0 += q.b0; b1 += q.b1; b2 += q.b2;
+    c += q.c;
+    weight += q.weight;
+    return *this;
+}
+
+double MeshOptimizer::Quadric::error(const glm::vec3& p) const
+{
+    if (weight <= 0.0)
+        return 0.0;
+
+    const double x = p.x, y = p.y, z = p.z;
+    const double e = a00*x*x + a11*y*y + a22*z*z + 2.0*(a01*x*y + a02*x*z + a12*y*z) + 2.0*(b0*x + b1*y + b2*z) + c;
+    return std::max(e, 0.0) / weight;
+}
+
+std::vector<MeshLod> MeshOptimizer::simplify(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<std::array<uint32_t, 3>>& indices, const std::span<const float> ratios, const float maxError)
+{
+    std::vector<MeshLod> lods;
+    if (indices.empty() || ratios.empty())
+        return lods;
+
+    const size_t numVertices = positions.size();
+
+    // vertices split at creases share a position, the collapses work on one canonical vertex per position
+    // and the triangles pick the split vertex with the closest normal afterwards
+    std::vector<uint32_t> canonical(numVertices);
+    std::vector<uint32_t> wedgeOffsets(numVertices + 1, 0), wedges(numVertices);
+    {
+        const auto positionKey = [&positions](const uint32_t i) {
+            const auto bits = std::bit_cast<std::array<uint32_t, 3>>(positions[i]);
+            return (static_cast<uint64_t>(bits[0])*73856093) ^ (static_cast<uint64_t>(bits[1])*19349663) ^ (static_cast<uint64_t>(bits[2])*83492791);
+        };
+
+        std::unordered_multimap<uint64_t, uint32_t> firsts;
+        firsts.reserve(numVertices);
+        for (uint32_t i = 0; i < numVertices; ++i) {
+            canonical[i] = i;
+            const uint64_t key = positionKey(i);
+            const auto [begin, end] = firsts.equal_range(key);
+            const auto it = std::find_if(begin, end, [&](const auto& entry) { return positions[entry.second] == positions[i]; });
+            if (it != end)
+                canonical[i] = it->second;
+            else
+                firsts.emplace(key, i);
+        }
+
+        for (uint32_t i = 0; i < numVertices; ++i)
+            wedgeOffsets[canonical[i] + 1]++;
+        for (size_t i = 0; i < numVertices; ++i)
+            wedgeOffsets[i + 1] += wedgeOffsets[i];
+        std::vector<uint32_t> fill(wedgeOffsets.begin(), wedgeOffsets.end() - 1);
+        for (uint32_t i = 0; i < numVertices; ++i)
+            wedges[fill[canonical[i]]++] = i;
+    }
+
+    const auto triangleNormal = [&positions, &canonical](const uint32_t i0, const uint32_t i1, const uint32_t i2) {
+        const glm::vec3& p0 = positions[canonical[i0]];
+        return glm::cross(positions[canonical[i1]] - p0, positions[canonical[i2]] - p0);
+    };
+
+    // area weighted face planes, plus planes perpendicular to open borders
+    std::vector<Quadric> quadrics(numVertices);
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(3*indices.size());
+    for (const auto& triangle : indices) {
+        const glm::vec3 n = triangleNormal(triangle[0], triangle[1], triangle[2]);
+        const float area = glm::length(n);
+        if (area <= 0.0f)
+            continue;
+
+        const glm::vec3 n_unit = n / area;
+        const Quadric q(n_unit, -glm::dot(n_unit, positions[canonical[triangle[0]]]), 0.5*area);
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t a = canonical[triangle[k]], b = canonical[triangle[(k + 1)%3]];
+            quadrics[a] += q;
+            edges.push_back({ std::min(a, b), std::max(a, b) });
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    for (const auto& triangle : indices)
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t a = canonical[triangle[k]], b = canonical[triangle[(k + 1)%3]];
+            const auto range = std::equal_range(edges.begin(), edges.end(), std::make_pair(std::min(a, b), std::max(a, b)));
+            if (range.second - range.first != 1)
+                continue;
+
+            const glm::vec3 v_edge = positions[b] - positions[a];
+            const glm::vec3 n_border = glm::cross(v_edge, triangleNormal(triangle[0], triangle[1], triangle[2]));
+            if (glm::length(n_border) <= 0.0f)
+                continue;
+
+            const glm::vec3 n_unit = glm::normalize(n_border);
+            const Quadric q(n_unit, -glm::dot(n_unit, positions[a]), s_boundaryWeight*glm::dot(v_edge, v_edge));
+            quadrics[a] += q;
+            quadrics[b] += q;
+        }
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double error;
+    };
+
+    std::vector<std::array<uint32_t, 3>> triangles = indices;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapsedTo(numVertices, s_none);
+    std::vector<bool> locked(numVertices);
+    std::vector<uint32_t> adjacencyOffsets(numVertices + 1), adjacency;
+    const double maxError2 = static_cast<double>(maxError)*maxError;
+    double error2 = 0.0;
+    size_t level = 0;
+    size_t lastCount = indices.size();
+
+    const auto addLevel = [&]() {
+        lods.push_back({ triangles, static_cast<float>(std::sqrt(error2)) });
+        optimizeVertexCache(lods.back().indices, numVertices);
+        lastCount = triangles.size();
+    };
+
+    while (level < ratios.size()) {
+        const size_t target = static_cast<size_t>(ratios[level]*indices.size());
+        if (triangles.size() <= target) {
+            if (triangles.size() <= s_minReduction*lastCount)
+                addLevel();
+            level++;
+            continue;
+        }
+
+        // canonical triangle adjacency of the current level
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (const auto& triangle : triangles)
+            for (const uint32_t index : triangle)
+                adjacencyOffsets[canonical[index] + 1]++;
+        for (size_t i = 0; i < numVertices; ++i)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        adjacency.resize(adjacencyOffsets.back());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t t = 0; t < triangles.size(); ++t)
+            for (const uint32_t index : triangles[t])
+                adjacency[fill[canonical[index]]++] = t;
+
+        // cheaper direction of every edge, sorted by error
+        edges.clear();
+        for (const auto& triangle : triangles)
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t a = canonical[triangle[k]], b = canonical[triangle[(k + 1)%3]];
+                edges.push_back({ std::min(a, b), std::max(a, b) });
+            }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (const auto& [a, b] : edges) {
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            const double errorA = q.error(positions[a]);
+            const double errorB = q.error(positions[b]);
+            collapses.push_back(errorA < errorB ? Collapse{ b, a, errorA } : Collapse{ a, b, errorB });
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.error < r.error; });
+
+        // one collapse removes about two triangles, vertices around a collapse stay untouched for the rest of the pass
+        const size_t maxCollapses = (triangles.size() - target)/2 + 1;
+        size_t numCollapses = 0;
+        std::fill(locked.begin(), locked.end(), false);
+        for (const auto& collapse : collapses) {
+            if (collapse.error > maxError2 || numCollapses == maxCollapses)
+                break;
+            if (locked[collapse.from] || locked[collapse.to])
+                continue;
+
+            // reject collapses that flip a remaining triangle
+            bool flips = false;
+            for (uint32_t j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1] && !flips; ++j) {
+                const auto& triangle = triangles[adjacency[j]];
+                std::array<uint32_t, 3> moved = { canonical[triangle[0]], canonical[triangle[1]], canonical[triangle[2]] };
+                if (std::find(moved.begin(), moved.end(), collapse.to) != moved.end())
+                    continue;
+
+                const glm::vec3 n = triangleNormal(moved[0], moved[1], moved[2]);
+                std::replace(moved.begin(), moved.end(), collapse.from, collapse.to);
+                flips = glm::dot(n, triangleNormal(moved[0], moved[1], moved[2])) <= 0.0f;
+            }
+            if (flips)
+                continue;
+
+            for (uint32_t j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1]; ++j)
+                for (const uint32_t index : triangles[adjacency[j]])
+                    locked[canonical[index]] = true;
+
+            collapsedTo[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            error2 = std::max(error2, collapse.error);
+            numCollapses++;
+        }
+
+        if (numCollapses == 0) {
+            if (triangles.size() <= s_minReduction*lastCount)
+                addLevel();
+            break;
+        }
+
+        for (auto& triangle : triangles)
+            for (auto& index : triangle) {
+                const uint32_t to = collapsedTo[canonical[index]];
+                if (to == s_none)
+                    continue;
+
+                const glm::vec3& n = normals[index];
+                index = *std::max_element(wedges.begin() + wedgeOffsets[to], wedges.begin() + wedgeOffsets[to + 1], [&](const uint32_t l, const uint32_t r) {
+                    return glm::dot(normals[l], n) < glm::dot(normals[r], n);
+                });
+            }
+        std::erase_if(triangles, [&canonical](const std::array<uint32_t, 3>& triangle) {
+            return canonical[triangle[0]] == canonical[triangle[1]] || canonical[triangle[1]] == canonical[triangle[2]] || canonical[triangle[0]] == canonical[triangle[2]];
+        });
+        std::fill(collapsedTo.begin(), collapsedTo.end(), s_none);
+    }
+
+    return lods;
+}
+
+size_t MeshOptimizer::cacheMisses(const std::vector<std::array<uint32_t, 3>>& indices, const size_t numVertices, const size_t cacheSize)
+{
+    // a vertex is still cached if fewer than cacheSize other vertices were loaded since its own load
+    std::vector<size_t> loaded(numVertices, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (const auto& triangle : indices)
+        for (const uint32_t index : triangle)
+            if (time - loaded[index] > cacheSize) {
+                loaded[index] = time++;
+                misses++;
+            }
+
+    return misses;
+}
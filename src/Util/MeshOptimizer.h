@@ -0,0 +1,79 @@
+#pragma once
+
+struct MeshOptimizerStats
+{
+    size_t numVerticesBefore = 0;
+    size_t numVerticesAfter = 0;
+    size_t numTrianglesBefore = 0;
+    size_t numTrianglesAfter = 0;
+    size_t cacheMissesBefore = 0;
+    size_t cacheMissesAfter = 0;
+
+    // average cache miss ratio, transformed vertices per triangle
+    inline float acmrBefore() const { return numTrianglesBefore > 0 ? static_cast<float>(cacheMissesBefore) / numTrianglesBefore : 0.0f; }
+    inline float acmrAfter() const { return numTrianglesAfter > 0 ? static_cast<float>(cacheMissesAfter) / numTrianglesAfter : 0.0f; }
+};
+
+// coarser index list over the vertices of the full resolution mesh, error is a distance in mesh units
+struct MeshLod
+{
+    std::vector<std::array<uint32_t, 3>> indices;
+    float error;
+};
+
+// import time clean up of indexed triangle lists, positions and normals are reordered in place
+class MeshOptimizer
+{
+public:
+    // weld, drop degenerate triangles, reorder for the post-transform cache, then for vertex fetch
+    static void optimize(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices, MeshOptimizerStats& stats);
+
+    // merges vertices closer than epsilon whose normals are within the crease angle, the merged normals are averaged
+    static void weld(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices, const float epsilon, const float creaseCos = s_creaseCos);
+    static void removeDegenerates(std::vector<std::array<uint32_t, 3>>& indices);
+
+    // forsyth's linear speed vertex cache optimization, only the triangle order changes
+    static void optimizeVertexCache(std::vector<std::array<uint32_t, 3>>& indices, const size_t numVertices);
+
+    // renumbers vertices in order of first use and drops unreferenced ones
+    static void optimizeVertexFetch(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<std::array<uint32_t, 3>>& indices);
+
+    // quadric error edge collapses onto existing vertices, one level per ratio of the input triangle count,
+    // levels are cache optimized and share the vertices, stops early once a collapse would exceed maxError
+    static std::vector<MeshLod> simplify(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, const std::vector<std::array<uint32_t, 3>>& indices, const std::span<const float> ratios, const float maxError);
+
+    // misses of a fifo cache, divided by the number of triangles this is the acmr
+    static size_t cacheMisses(const std::vector<std::array<uint32_t, 3>>& indices, const size_t numVertices, const size_t cacheSize = s_fifoSize);
+
+private:
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        Quadric() = default;
+        Quadric(const glm::vec3& n, const float d, const double w);
+
+        Quadric& operator+=(const Quadric& q);
+
+        // weighted mean of the squared plane distances
+        double error(const glm::vec3& p) const;
+    };
+
+    inline static constexpr size_t s_cacheSize = 32;
+    inline static constexpr size_t s_fifoSize = 16;
+
+    // about 25 degrees, keeps hard cad edges and smooths tessellated curved surfaces
+    inline static constexpr float s_creaseCos = 0.9f;
+
+    // relative to the bounding box diagonal, well below the 16 bit position quantization
+    inline static constexpr float s_weldEpsilon = 1e-6f;
+
+    // open borders resist collapses more than the surface itself
+    inline static constexpr double s_boundaryWeight = 10.0;
+
+    // a level is only kept if it drops at least a quarter of the triangles of the previous one
+    inline static constexpr float s_minReduction = 0.75f;
+};
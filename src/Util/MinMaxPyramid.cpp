@@ -0,0 +1,84 @@
+#include "pch.h"
+
+#include "MinMaxPyramid.h"
+
+static MinMaxPyramid::Bin merge(const MinMaxPyramid::Bin& a, const MinMaxPyramid::Bin& b)
+{
+    return { std::min(a.min, b.min), std::max(a.max, b.max) };
+}
+
+void MinMaxPyramid::build(const float* values, const size_t numSamples, const size_t stride)
+{
+    m_values = values;
+    m_numSamples = numSamples;
+    m_stride = stride;
+    m_levels.clear();
+    m_range = { 0.0f, 0.0f };
+    if (numSamples == 0)
+        return;
+
+    // the last bin of a level may be partial
+    for (size_t level = 0; numElements(level) > 1; ++level) {
+        const size_t count = numElements(level);
+        const size_t group = level == 0 ? s_baseBinSize : s_factor;
+
+        std::vector<Bin> bins((count + group - 1) / group);
+        for (size_t i = 0; i < bins.size(); ++i) {
+            bins[i] = element(level, i*group);
+            for (size_t k = i*group + 1; k < std::min((i + 1)*group, count); ++k)
+                bins[i] = merge(bins[i], element(level, k));
+        }
+        m_levels.push_back(std::move(bins));
+    }
+
+    m_range = m_levels.empty() ? element(0, 0) : m_levels.back().front();
+}
+
+size_t MinMaxPyramid::query(const size_t first, const size_t last, const size_t maxBins, std::vector<Bin>& bins, size_t& firstSample) const
+{
+    bins.clear();
+    firstSample = first;
+    if (first >= last || last > m_numSamples || maxBins == 0)
+        return 1;
+
+    // finest level that is cheap enough to merge on the fly, at most s_baseBinSize elements per bin
+    size_t level = 0;
+    while (level < m_levels.size() && (last - first) / binSize(level) > maxBins*s_baseBinSize)
+        level++;
+
+    const size_t elementSize = binSize(level);
+    const size_t end = std::min((last + elementSize - 1) / elementSize, numElements(level));
+    const size_t group = std::max<size_t>((end - first / elementSize + maxBins - 1) / maxBins, 1);
+
+    // aligned to the group, panning moves whole bins
+    const size_t begin = first / elementSize / group * group;
+    for (size_t i = begin; i < end; i += group) {
+        Bin bin = element(level, i);
+        for (size_t k = i + 1; k < std::min(i + group, end); ++k)
+            bin = merge(bin, element(level, k));
+        bins.push_back(bin);
+    }
+
+    firstSample = begin*elementSize;
+    return group*elementSize;
+}
+
+size_t MinMaxPyramid::binSize(const size_t level)
+{
+    size_t size = 1;
+    for (size_t i = 0; i < level; ++i)
+        size *= i == 0 ? s_baseBinSize : s_factor;
+    return size;
+}
+
+size_t MinMaxPyramid::numElements(const size_t level) const
+{
+    return level == 0 ? m_numSamples : m_levels[level - 1].size();
+}
+
+MinMaxPyramid::Bin MinMaxPyramid::element(const size_t level, const size_t i) const
+{
+    if (level == 0)
+        return { m_values[i*m_stride], m_values[i*m_stride] };
+    return m_levels[level - 1][i];
+}
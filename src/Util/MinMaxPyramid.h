@@ -0,0 +1,42 @@
+#pragma once
+
+// min/max envelopes of a series over bins of s_baseBinSize samples, each level s_factor times coarser,
+// drawing bins instead of samples keeps every peak visible at any zoom
+class MinMaxPyramid
+{
+public:
+    struct Bin
+    {
+        float min;
+        float max;
+    };
+
+    MinMaxPyramid() = default;
+    ~MinMaxPyramid() = default;
+
+    // sample k is values[k*stride], the values have to outlive the pyramid
+    void build(const float* values, const size_t numSamples, const size_t stride);
+
+    // about maxBins bins covering the samples [first, last), each spans the returned number of samples,
+    // the first one starts at firstSample, boundaries stay put while the range moves
+    size_t query(const size_t first, const size_t last, const size_t maxBins, std::vector<Bin>& bins, size_t& firstSample) const;
+
+    // over the whole series
+    inline const Bin& getRange() const { return m_range; }
+
+    inline static constexpr size_t s_baseBinSize = 64;
+    inline static constexpr size_t s_factor = 4;
+
+private:
+    // level 0 are the samples themselves
+    static size_t binSize(const size_t level);
+    size_t numElements(const size_t level) const;
+    Bin element(const size_t level, const size_t i) const;
+
+    const float* m_values = nullptr;
+    size_t m_numSamples = 0;
+    size_t m_stride = 0;
+
+    std::vector<std::vector<Bin>> m_levels;
+    Bin m_range = { 0.0f, 0.0f };
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+class ThreadPool
+{
+public:
+    ThreadPool(const size_t numThreads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (size_t i = 0; i < numThreads; ++i)
+            m_threads.emplace_back([this](const std::stop_token& token) { work(token); });
+    }
+
+    ~ThreadPool() = default;
+
+    template<typename F>
+    auto submit(F&& func) -> std::future<std::invoke_result_t<F>>
+    {
+        using R = std::invoke_result_t<F>;
+
+        // packaged_task is move-only, std::function needs something copyable
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace([task]() { (*task)(); });
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    inline size_t size() const { return m_threads.size(); }
+
+    static ThreadPool& get()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    void work(const std::stop_token& token)
+    {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                if (!m_condition.wait(lock, token, [this] { return !m_tasks.empty(); }))
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable_any m_condition;
+
+    // declared last so the workers are joined before the queue goes away
+    std::vector<std::jthread> m_threads;
+
+};
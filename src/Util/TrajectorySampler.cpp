@@ -0,0 +1,146 @@
+#include "pch.h"
+
+#include "TrajectorySampler.h"
+
+#include "simd.h"
+
+static_assert(TrajectorySampler::s_strideAlignment % SimdFloat::s_width == 0, "Coefficient rows have to fill whole simd floats");
+
+bool TrajectorySampler::build(const std::span<const double> times, const std::span<const float> values, const size_t numJoints, const std::function<void(float)>& progress)
+{
+    clear();
+
+    const size_t n = times.size();
+    if (n == 0 || numJoints == 0 || values.size() < n*numJoints)
+        return false;
+
+    m_ownedTimes.assign(times.begin(), times.end());
+    m_numJoints = numJoints;
+    m_stride = stride(numJoints);
+    m_ownedCoefficients.assign(numCoefficients(n, numJoints), 0.0f);
+
+    // one sided at the ends, repeated time stamps get a flat tangent
+    const auto tangent = [&](const float* p, const size_t k) -> double {
+        const size_t prev = k > 0 ? k - 1 : 0;
+        const size_t next = std::min(k + 1, n - 1);
+        const double dt = times[next] - times[prev];
+        return dt > 0.0 ? (p[next] - p[prev]) / dt : 0.0;
+    };
+
+    // sample major, every block is written in one go
+    for (size_t begin = 0; begin < n; begin += s_progressSamples) {
+        if (progress)
+            progress(static_cast<float>(begin) / n);
+        for (size_t k = begin, end = std::min(begin + s_progressSamples, n); k < end; ++k) {
+            float* c = m_ownedCoefficients.data() + k*s_rows*m_stride;
+            for (size_t j = 0; j < numJoints; ++j) {
+                const float* p = values.data() + j*n;
+                c[j] = p[k];
+                c[m_stride + j] = static_cast<float>(tangent(p, k));
+            }
+        }
+    }
+
+    m_times = m_ownedTimes;
+    m_coefficients = m_ownedCoefficients;
+    return true;
+}
+
+bool TrajectorySampler::view(const std::span<const double> times, const std::span<const float> coefficients, const size_t numJoints, std::shared_ptr<const void> owner)
+{
+    clear();
+
+    if (times.empty() || numJoints == 0 || coefficients.size() != numCoefficients(times.size(), numJoints))
+        return false;
+
+    m_times = times;
+    m_coefficients = coefficients;
+    m_numJoints = numJoints;
+    m_stride = stride(numJoints);
+    m_owner = std::move(owner);
+    return true;
+}
+
+void TrajectorySampler::clear()
+{
+    m_times = {};
+    m_coefficients = {};
+    m_numJoints = 0;
+    m_stride = 0;
+    m_ownedTimes.clear();
+    m_ownedCoefficients.clear();
+    m_owner.reset();
+}
+
+void TrajectorySampler::sample(const double t, Cursor& cursor, const std::span<float> jointValues) const
+{
+    if (empty())
+        return;
+
+    const double time = std::clamp(t, startTime(), endTime());
+    const size_t segment = findSegment(time, cursor);
+
+    // hermite basis of the segment, the same weights for all joints, the end of the recording is constant
+    const size_t next = std::min(segment + 1, numSamples() - 1);
+    const double h = m_times[next] - m_times[segment];
+    const double s = h > 0.0 ? (time - m_times[segment]) / h : 0.0;
+    const double r = 1.0 - s;
+    const SimdFloat w00 = SimdFloat::broadcast(static_cast<float>((1.0 + 2.0*s)*r*r));
+    const SimdFloat w10 = SimdFloat::broadcast(static_cast<float>(s*r*r*h));
+    const SimdFloat w01 = SimdFloat::broadcast(static_cast<float>(s*s*(3.0 - 2.0*s)));
+    const SimdFloat w11 = SimdFloat::broadcast(static_cast<float>(-s*s*r*h));
+
+    constexpr size_t width = SimdFloat::s_width;
+    const float* c0 = m_coefficients.data() + segment*s_rows*m_stride;
+    const float* c1 = m_coefficients.data() + next*s_rows*m_stride;
+    const size_t count = std::min(m_numJoints, jointValues.size());
+
+    std::array<float, width> lanes;
+    for (size_t j = 0; j < count; j += width) {
+        SimdFloat v = w00*SimdFloat::load(c0 + j);
+        v = SimdFloat::fma(w10, SimdFloat::load(c0 + m_stride + j), v);
+        v = SimdFloat::fma(w01, SimdFloat::load(c1 + j), v);
+        v = SimdFloat::fma(w11, SimdFloat::load(c1 + m_stride + j), v);
+
+        if (j + width <= count)
+            v.store(jointValues.data() + j);
+        else {
+            v.store(lanes.data());
+            std::copy_n(lanes.begin(), count - j, jointValues.begin() + j);
+        }
+    }
+}
+
+size_t TrajectorySampler::findSegment(const double t, Cursor& cursor) const
+{
+    const size_t last = m_times.size() - 1;
+    size_t segment = std::min(cursor.segment, last);
+
+    if (t >= m_times[segment]) {
+        if (segment == last || t < m_times[segment + 1])
+            return segment;
+
+        // times[lo] <= t, double the step until it overshoots
+        size_t lo = segment + 1, step = 1;
+        while (lo + step <= last && m_times[lo + step] <= t) {
+            lo += step;
+            step *= 2;
+        }
+        const size_t hi = std::min(lo + step, last + 1);
+        segment = std::upper_bound(m_times.begin() + lo, m_times.begin() + hi, t) - m_times.begin() - 1;
+    }
+    else {
+        // times[hi] > t, same backwards
+        size_t hi = segment, step = 1;
+        while (hi >= step && m_times[hi - step] > t) {
+            hi -= step;
+            step *= 2;
+        }
+        const size_t lo = hi >= step ? hi - step : 0;
+        segment = std::upper_bound(m_times.begin() + lo, m_times.begin() + hi, t) - m_times.begin();
+        segment = segment > 0 ? segment - 1 : 0;
+    }
+
+    cursor.segment = segment;
+    return segment;
+}
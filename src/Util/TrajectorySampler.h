@@ -0,0 +1,74 @@
+#pragma once
+
+// piecewise cubic hermite spline through recorded joint values, catmull-rom tangents keep it C1
+// and local, so one bad sample only bends its neighbouring segments
+class TrajectorySampler
+{
+public:
+    // last segment found, continuous playback finds the next one in O(1)
+    struct Cursor
+    {
+        size_t segment = 0;
+    };
+
+    TrajectorySampler() = default;
+    ~TrajectorySampler() = default;
+
+    // the views point into the owned storage
+    TrajectorySampler(const TrajectorySampler&) = delete;
+    TrajectorySampler& operator=(const TrajectorySampler&) = delete;
+
+    // values holds times.size() values per joint (joint major), times have to be ascending,
+    // progress is called with the share of samples done
+    bool build(const std::span<const double> times, const std::span<const float> values, const size_t numJoints, const std::function<void(float)>& progress = {});
+
+    // samples data laid out like getCoefficients() in place, owner keeps it alive, e.g. a file mapping
+    bool view(const std::span<const double> times, const std::span<const float> coefficients, const size_t numJoints, std::shared_ptr<const void> owner);
+    void clear();
+
+    // clamps t to the recording, writes min(numJoints, jointValues.size()) values
+    void sample(const double t, Cursor& cursor, const std::span<float> jointValues) const;
+
+    // gallops from the cursor, O(log d) for a jump over d samples
+    size_t findSegment(const double t, Cursor& cursor) const;
+
+    inline float value(const size_t sample, const size_t joint) const { return m_coefficients[sample*s_rows*m_stride + joint]; }
+    inline float slope(const size_t sample, const size_t joint) const { return m_coefficients[sample*s_rows*m_stride + m_stride + joint]; }
+
+    // whole series of one joint, sample k sits at k*seriesStride()
+    inline const float* getValues(const size_t joint) const { return m_coefficients.data() + joint; }
+    inline const float* getSlopes(const size_t joint) const { return m_coefficients.data() + m_stride + joint; }
+    inline size_t seriesStride() const { return s_rows*m_stride; }
+
+    // joints rounded up to s_strideAlignment, the layout does not depend on the simd width of the build
+    static inline size_t stride(const size_t numJoints) { return (numJoints + s_strideAlignment - 1) / s_strideAlignment * s_strideAlignment; }
+    static inline size_t numCoefficients(const size_t numSamples, const size_t numJoints) { return numSamples*s_rows*stride(numJoints); }
+
+    inline bool empty() const { return m_times.empty(); }
+    inline size_t numSamples() const { return m_times.size(); }
+    inline size_t numJoints() const { return m_numJoints; }
+    inline double startTime() const { return m_times.front(); }
+    inline double endTime() const { return m_times.back(); }
+    inline std::span<const double> getTimes() const { return m_times; }
+    inline std::span<const float> getCoefficients() const { return m_coefficients; }
+
+    // the widest simd float
+    inline static constexpr size_t s_strideAlignment = 8;
+    inline static constexpr size_t s_rows = 2;
+
+private:
+    inline static constexpr size_t s_progressSamples = 64*1024;
+
+    std::span<const double> m_times;
+
+    // one block per sample, a row of m_stride values and one of slopes per second, the cubic of a
+    // segment follows from its two neighbouring blocks
+    std::span<const float> m_coefficients;
+    size_t m_numJoints = 0;
+    size_t m_stride = 0;
+
+    // storage of built samplers, views leave it empty
+    std::vector<double> m_ownedTimes;
+    std::vector<float> m_ownedCoefficients;
+    std::shared_ptr<const void> m_owner;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+// single producer, single consumer, the writer never waits for the reader and the reader always sees
+// the newest complete value, older ones are dropped
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    ~TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // writer side, the buffer stays private to the writer until publish()
+    inline T& writeBuffer() { return m_buffers[m_write]; }
+
+    void publish()
+    {
+        m_write = m_middle.exchange(m_write | s_fresh, std::memory_order_acq_rel) & s_index;
+    }
+
+    // reader side, swaps in the newest published buffer, false if nothing was published since the last call
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & s_fresh))
+            return false;
+
+        m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & s_index;
+        return true;
+    }
+
+    inline bool hasUpdate() const { return m_middle.load(std::memory_order_relaxed) & s_fresh; }
+    inline const T& read() const { return m_buffers[m_read]; }
+
+    // only while neither side is running, e.g. to size all buffers up front
+    template<typename F>
+    void forEach(F&& func)
+    {
+        for (auto& buffer : m_buffers)
+            func(buffer);
+    }
+
+private:
+    inline static constexpr uint8_t s_index = 0x3;
+    inline static constexpr uint8_t s_fresh = 0x4;
+
+    std::array<T, 3> m_buffers;
+    uint8_t m_write = 0;
+    std::atomic<uint8_t> m_middle = 1;
+    uint8_t m_read = 2;
+};
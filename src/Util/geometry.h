@@ -142,6 +142,15 @@ static glm::mat3 getMat4Rotation(const glm::mat4& mat)
     return MAT3(mat, 0, 0);
 }
 
+// slerps the rotation and lerps the translation, both inputs have to be rigid
+static glm::mat4 interpolateMat4(const glm::mat4& a, const glm::mat4& b, const float t)
+{
+    glm::mat4 result(1.0f);
+    setMat4Rotation(result, glm::mat3_cast(glm::slerp(glm::quat_cast(getMat4Rotation(a)), glm::quat_cast(getMat4Rotation(b)), t)));
+    setMat4Translation(result, glm::mix(getMat4Translation(a), getMat4Translation(b), t));
+    return result;
+}
+
 static glm::vec4 extendedCross(const glm::vec4& A, const glm::vec4& B, const glm::vec4& C)
 {
     //              --                           --
@@ -203,6 +212,48 @@ static bool intersectionLinePlane(const glm::vec3& n_plane, const glm::vec3& p_p
     return true;
 }
 
+static bool intersectionRayTriangle(const glm::vec3& p_ray, const glm::vec3& v_ray, const std::array<glm::vec3, 3>& p_tri, float& t)
+{
+    // https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
+    constexpr float eps = 1e-7f;
+
+    const auto v_edge1 = p_tri[1] - p_tri[0];
+    const auto v_edge2 = p_tri[2] - p_tri[0];
+    const auto h = glm::cross(v_ray, v_edge2);
+    const float det = glm::dot(v_edge1, h);
+    if (std::abs(det) < eps)
+        return false;
+
+    const float detInv = 1.0f / det;
+    const auto s = p_ray - p_tri[0];
+    const float u = detInv * glm::dot(s, h);
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    const auto q = glm::cross(s, v_edge1);
+    const float v = detInv * glm::dot(v_ray, q);
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    t = detInv * glm::dot(v_edge2, q);
+    return t > 0.0f;
+}
+
+static float intersectionRayAabb(const glm::vec3& p_ray, const glm::vec3& v_rayInv, const glm::vec3& p_min, const glm::vec3& p_max, const float tMax)
+{
+    // slab test, returns the entry distance or float max on a miss
+    const float tx1 = (p_min.x - p_ray.x) * v_rayInv.x, tx2 = (p_max.x - p_ray.x) * v_rayInv.x;
+    float tNear = std::min(tx1, tx2), tFar = std::max(tx1, tx2);
+    const float ty1 = (p_min.y - p_ray.y) * v_rayInv.y, ty2 = (p_max.y - p_ray.y) * v_rayInv.y;
+    tNear = std::max(tNear, std::min(ty1, ty2)), tFar = std::min(tFar, std::max(ty1, ty2));
+    const float tz1 = (p_min.z - p_ray.z) * v_rayInv.z, tz2 = (p_max.z - p_ray.z) * v_rayInv.z;
+    tNear = std::max(tNear, std::min(tz1, tz2)), tFar = std::min(tFar, std::max(tz1, tz2));
+
+    if (tFar >= tNear && tNear < tMax && tFar > 0.0f)
+        return tNear;
+    return std::numeric_limits<float>::max();
+}
+
 static int16_t location(const glm::vec3& N, const glm::vec3& P)
 {
     const float l = dot(N, P);
@@ -355,9 +406,15 @@ static float map(float x, float in_min, float in_max, float out_min, float out_m
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-static glm::vec3 strToVec3(const std::string& str)
+// octahedral unit vector as two snorm8 components, the lower hemisphere is folded over the diagonals
+static std::array<int8_t, 2> octEncode(const glm::vec3& n)
 {
-    const auto parts = splitString(str, ",; ");
-    assert(parts.size() == 3 && "Wrong number of vector elemets");
-    return glm::vec3(std::stof(parts[0]), std::stof(parts[1]), std::stof(parts[2]));
+    glm::vec2 p = glm::vec2(n.x, n.y) / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+    if (n.z < 0.0f)
+        p = glm::vec2((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+
+    return {
+        static_cast<int8_t>(std::round(std::clamp(p.x, -1.0f, 1.0f) * 127.0f)),
+        static_cast<int8_t>(std::round(std::clamp(p.y, -1.0f, 1.0f) * 127.0f))
+    };
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+// msvc implies fma with /arch:AVX2
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    #include <immintrin.h>
+    #define SIMD_AVX2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define SIMD_NEON
+#endif
+
+// float vector with one lane per data set, the scalar fallback is left to the auto vectorizer
+struct SimdFloat
+{
+#if defined(SIMD_AVX2)
+    inline static constexpr size_t s_width = 8;
+    __m256 v;
+
+    static inline SimdFloat load(const float* p) { return { _mm256_loadu_ps(p) }; }
+    static inline SimdFloat broadcast(const float f) { return { _mm256_set1_ps(f) }; }
+    inline void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    friend inline SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return { _mm256_add_ps(a.v, b.v) }; }
+    friend inline SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    friend inline SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return { _mm256_mul_ps(a.v, b.v) }; }
+
+    // a*b + c
+    static inline SimdFloat fma(const SimdFloat a, const SimdFloat b, const SimdFloat c) { return { _mm256_fmadd_ps(a.v, b.v, c.v) }; }
+    static inline SimdFloat min(const SimdFloat a, const SimdFloat b) { return { _mm256_min_ps(a.v, b.v) }; }
+    static inline SimdFloat max(const SimdFloat a, const SimdFloat b) { return { _mm256_max_ps(a.v, b.v) }; }
+    static inline SimdFloat round(const SimdFloat a) { return { _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+#elif defined(SIMD_NEON)
+    inline static constexpr size_t s_width = 4;
+    float32x4_t v;
+
+    static inline SimdFloat load(const float* p) { return { vld1q_f32(p) }; }
+    static inline SimdFloat broadcast(const float f) { return { vdupq_n_f32(f) }; }
+    inline void store(float* p) const { vst1q_f32(p, v); }
+
+    friend inline SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return { vaddq_f32(a.v, b.v) }; }
+    friend inline SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return { vsubq_f32(a.v, b.v) }; }
+    friend inline SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return { vmulq_f32(a.v, b.v) }; }
+
+    static inline SimdFloat fma(const SimdFloat a, const SimdFloat b, const SimdFloat c) { return { vfmaq_f32(c.v, a.v, b.v) }; }
+    static inline SimdFloat min(const SimdFloat a, const SimdFloat b) { return { vminq_f32(a.v, b.v) }; }
+    static inline SimdFloat max(const SimdFloat a, const SimdFloat b) { return { vmaxq_f32(a.v, b.v) }; }
+    static inline SimdFloat round(const SimdFloat a) { return { vrndnq_f32(a.v) }; }
+#else
+    inline static constexpr size_t s_width = 4;
+    std::array<float, 4> v;
+
+    static inline SimdFloat load(const float* p) { SimdFloat r; std::copy_n(p, s_width, r.v.begin()); return r; }
+    static inline SimdFloat broadcast(const float f) { SimdFloat r; r.v.fill(f); return r; }
+    inline void store(float* p) const { std::copy_n(v.begin(), s_width, p); }
+
+    template<typename F>
+    static inline SimdFloat apply(const SimdFloat a, const SimdFloat b, F f)
+    {
+        SimdFloat r;
+        for (size_t i = 0; i < s_width; ++i)
+            r.v[i] = f(a.v[i], b.v[i]);
+        return r;
+    }
+
+    friend inline SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return apply(a, b, std::plus<float>()); }
+    friend inline SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return apply(a, b, std::minus<float>()); }
+    friend inline SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return apply(a, b, std::multiplies<float>()); }
+
+    static inline SimdFloat fma(const SimdFloat a, const SimdFloat b, const SimdFloat c) { return a*b + c; }
+    static inline SimdFloat min(const SimdFloat a, const SimdFloat b) { return apply(a, b, [](const float x, const float y) { return std::min(x, y); }); }
+    static inline SimdFloat max(const SimdFloat a, const SimdFloat b) { return apply(a, b, [](const float x, const float y) { return std::max(x, y); }); }
+    static inline SimdFloat round(const SimdFloat a) { return apply(a, a, [](const float x, const float) { return std::nearbyint(x); }); }
+#endif
+};
+
+// sine on [-pi/2, pi/2], taylor up to x^11, error below 1e-7
+static inline SimdFloat simdSinReduced(const SimdFloat x)
+{
+    const SimdFloat x2 = x*x;
+    SimdFloat p = SimdFloat::broadcast(-2.5052108e-8f);
+    p = SimdFloat::fma(p, x2, SimdFloat::broadcast( 2.7557319e-6f));
+    p = SimdFloat::fma(p, x2, SimdFloat::broadcast(-1.9841270e-4f));
+    p = SimdFloat::fma(p, x2, SimdFloat::broadcast( 8.3333333e-3f));
+    p = SimdFloat::fma(p, x2, SimdFloat::broadcast(-1.6666667e-1f));
+    return SimdFloat::fma(p*x2, x, x);
+}
+
+// wraps to [-pi, pi] and mirrors the outer quarters, sin(x) = sin(pi - x)
+static inline SimdFloat simdSin(const SimdFloat x)
+{
+    const SimdFloat pi = SimdFloat::broadcast(3.14159265f);
+    const SimdFloat y = x - SimdFloat::broadcast(6.28318531f) * SimdFloat::round(x * SimdFloat::broadcast(0.159154943f));
+    const SimdFloat folded = SimdFloat::max(SimdFloat::min(y, pi - y), SimdFloat::broadcast(0.0f) - pi - y);
+    return simdSinReduced(folded);
+}
+
+static inline void simdSinCos(const SimdFloat x, SimdFloat& s, SimdFloat& c)
+{
+    s = simdSin(x);
+    c = simdSin(x + SimdFloat::broadcast(1.57079633f));
+}
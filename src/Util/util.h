@@ -1,17 +1,17 @@
 #pragma once
 
-static std::vector<std::string> splitString(std::string str, const char* delims)
+static std::vector<std::string> splitString(const std::string_view str, const char* delims)
 {
 	std::vector<std::string> parts;
 
 	size_t prev = 0, pos;
-	while ((pos = str.find_first_of(delims, prev)) != std::string::npos) {
+	while ((pos = str.find_first_of(delims, prev)) != std::string_view::npos) {
 		if (pos > prev)
-			parts.push_back(str.substr(prev, pos - prev));
+			parts.emplace_back(str.substr(prev, pos - prev));
 		prev = pos + 1;
 	}
 	if (prev < str.size())
-		parts.push_back(str.substr(prev, std::string::npos));
+		parts.emplace_back(str.substr(prev));
 
 	return parts;
 }
@@ -55,4 +55,65 @@ static uint32_t vecToRGBA(const glm::vec4& color)
 	const uint8_t a = static_cast<uint8_t>(color.a * 255.0f);
 
 	return (a << 24) | (b << 16) | (g << 8) | r;
-}
\ No newline at end of file
+}
+
+static uint64_t hashBytes(const void* data, const size_t size, uint64_t hash = 0)
+{
+	// murmurhash64a over 8 byte words, the xorshifts carry high input bits down so every bit reaches the
+	// whole hash, the previous hash seeds chained calls
+	constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+	constexpr int r = 47;
+	const char* bytes = static_cast<const char*>(data);
+
+	hash ^= size * m;
+
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(uint64_t));
+		word *= m;
+		word ^= word >> r;
+		word *= m;
+		hash = (hash ^ word) * m;
+	}
+	if (i < size) {
+		uint64_t tail = 0;
+		std::memcpy(&tail, bytes + i, size - i);
+		hash = (hash ^ tail) * m;
+	}
+
+	hash ^= hash >> r;
+	hash *= m;
+	hash ^= hash >> r;
+	return hash;
+}
+
+// parses a list of floats separated by spaces, commas or semicolons in one pass,
+// returns the number of values or nullopt if the string holds anything else or more values than fit
+static std::optional<size_t> parseFloats(const std::string_view str, const std::span<float> out)
+{
+	const char* it = str.data();
+	const char* const end = it + str.size();
+	const auto isSeparator = [](const char c) { return c == ' ' || c == ',' || c == ';' || c == '\n' || c == '\r' || c == '\t'; };
+
+	size_t n = 0;
+	while (true) {
+		while (it != end && isSeparator(*it))
+			++it;
+		if (it == end)
+			return n;
+		if (n == out.size())
+			return std::nullopt;
+
+		// from_chars rejects a leading '+'
+		if (*it == '+' && it + 1 != end && *(it + 1) != '-')
+			++it;
+
+		const auto [ptr, ec] = std::from_chars(it, end, out[n]);
+		if (ec != std::errc() || (ptr != end && !isSeparator(*ptr)))
+			return std::nullopt;
+
+		it = ptr;
+		n++;
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "XmlLexer.h"
+
+struct XmlAttribute
+{
+    uint32_t name;
+    XmlValue value;
+};
+
+// nodes reference each other by index, attributes of a node are stored contiguously
+struct XmlNode
+{
+    uint32_t tag;
+    uint32_t parent;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+    uint32_t firstAttribute;
+    uint32_t numAttributes;
+    std::string_view content;
+};
+
+// names, content and string values are views into the parsed source, which has to outlive the document
+class XmlDocument
+{
+public:
+    inline static constexpr uint32_t s_none = std::numeric_limits<uint32_t>::max();
+
+    XmlDocument() = default;
+    ~XmlDocument() = default;
+
+    uint32_t intern(const std::string_view name)
+    {
+        const auto [it, inserted] = m_ids.try_emplace(name, static_cast<uint32_t>(m_names.size()));
+        if (inserted)
+            m_names.push_back(name);
+        return it->second;
+    }
+
+    // unknown names map to s_none, which no node or attribute carries
+    inline uint32_t id(const std::string_view name) const
+    {
+        const auto it = m_ids.find(name);
+        return it != m_ids.end() ? it->second : s_none;
+    }
+    inline std::string_view name(const uint32_t id) const { return id < m_names.size() ? m_names[id] : std::string_view(); }
+
+    inline uint32_t root() const { return 0; }
+    inline const XmlNode& node(const uint32_t i) const { return m_nodes[i]; }
+    inline size_t numNodes() const { return m_nodes.size(); }
+    inline size_t numAttributes() const { return m_attributes.size(); }
+
+    inline uint32_t firstChild(const uint32_t node) const { return m_nodes[node].firstChild; }
+    inline uint32_t nextSibling(const uint32_t node) const { return m_nodes[node].nextSibling; }
+
+    uint32_t firstChild(const uint32_t node, const uint32_t tag) const
+    {
+        uint32_t child = m_nodes[node].firstChild;
+        while (child != s_none && m_nodes[child].tag != tag)
+            child = m_nodes[child].nextSibling;
+        return child;
+    }
+
+    uint32_t nextSibling(const uint32_t node, const uint32_t tag) const
+    {
+        uint32_t sibling = m_nodes[node].nextSibling;
+        while (sibling != s_none && m_nodes[sibling].tag != tag)
+            sibling = m_nodes[sibling].nextSibling;
+        return sibling;
+    }
+
+    size_t numChildren(const uint32_t node) const
+    {
+        size_t count = 0;
+        for (uint32_t child = firstChild(node); child != s_none; child = nextSibling(child))
+            count++;
+        return count;
+    }
+
+    const XmlValue* attribute(const uint32_t node, const uint32_t name) const
+    {
+        const auto& n = m_nodes[node];
+        for (uint32_t i = n.firstAttribute; i < n.firstAttribute + n.numAttributes; ++i)
+            if (m_attributes[i].name == name)
+                return &m_attributes[i].value;
+        return nullptr;
+    }
+
+    template<typename T>
+    const T* attribute(const uint32_t node, const uint32_t name) const
+    {
+        const XmlValue* value = attribute(node, name);
+        return value != nullptr ? std::get_if<T>(value) : nullptr;
+    }
+
+    void print(const uint32_t node = 0, const int level = 0) const
+    {
+        if (level > 0) {
+            std::string ident(level-1, '\t');
+            std::cout << ident << "tag: " << name(m_nodes[node].tag);
+            if (m_nodes[node].numAttributes > 0) {
+                std::cout << ", attr:";
+                for (uint32_t i = 0; i < m_nodes[node].numAttributes; ++i) {
+                    const auto& [attrName, val] = m_attributes[m_nodes[node].firstAttribute + i];
+                    std::cout << " " << name(attrName) << "=";
+                    if (const auto i = std::get_if<int>(&val); i != nullptr)
+                        std::cout << std::to_string(*i);
+                    else if (const auto f = std::get_if<float>(&val); f != nullptr)
+                        std::cout << std::to_string(*f);
+                    else if (const auto v = std::get_if<glm::vec3>(&val); v != nullptr)
+                        std::cout << v->x << " " << v->y << " " << v->z;
+                    else
+                        std::cout << std::get<std::string_view>(val);
+                }
+            }
+            std::cout << ", content: " << m_nodes[node].content << '\n';
+        }
+
+        for (uint32_t child = firstChild(node); child != s_none; child = nextSibling(child))
+            print(child, level+1);
+    }
+
+private:
+    friend class XmlParser;
+
+    std::vector<XmlNode> m_nodes;
+    std::vector<XmlAttribute> m_attributes;
+
+    std::unordered_map<std::string_view, uint32_t> m_ids;
+    std::vector<std::string_view> m_names;
+
+};
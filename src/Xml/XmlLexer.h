@@ -10,199 +10,144 @@ enum class XmlTokenType
     CONTENT
 };
 
+// numbers and three element lists (xyz, rpy, scale) are parsed once, everything else stays a view
+using XmlValue = std::variant<int, float, glm::vec3, std::string_view>;
+
+// views into the lexed source, valid as long as the source is
 struct XmlToken
 {
     XmlTokenType type;
-    std::string tag;
-    std::string data;
+    std::string_view tag;
+    std::string_view data;
 };
 
 class XmlLexer
 {
 public:
-    XmlLexer(const std::string& raw) : m_raw(raw), m_i(0) {}
+    XmlLexer(const std::string_view raw) : m_raw(raw), m_i(0) {}
 
-    std::vector<XmlToken> generateTokens()
+    bool next(XmlToken& token)
     {
-        m_tokens.clear();
-        m_i = 0;
-
-        bool isContent = false;
-        size_t contentStart = 0;
-        size_t contentEnd = 0;
-        while(m_i < m_raw.size()) {
-
-            if (m_raw[m_i] == '<') {                
-                // content end
-                if (isContent) {
-                    isContent = false;
-
-                    contentEnd = m_i;
-
-                    m_tokens.emplace_back(
-                        XmlTokenType::CONTENT,
-                        "",
-                        m_raw.substr(contentStart, contentEnd-contentStart)
-                    );
-                    
-                    auto& content = m_tokens.back().data;
-                    content.erase(std::remove(content.begin(), content.end(), '\n'), content.end());
-                    content.erase(std::remove(content.begin(), content.end(), '\r'), content.end());
-                }
+        while (m_i < m_raw.size()) {
 
-                m_i++;
+            // content
+            if (m_raw[m_i] != '<') {
+                const size_t start = m_i;
+                m_i = std::min(m_raw.find('<', m_i), m_raw.size());
 
-                // comment
-                if (m_raw[m_i] == '!' && m_raw[m_i+1] == '-' && m_raw[m_i+2] == '-') {
-                    m_i += 3;
-                    generateCommentXmlToken();
-                }
-                // instruction
-                if (m_raw[m_i] == '?') {
-                    m_i++;
-                    generateInstructionXmlToken();
-                }
-                // end of node
-                else if (m_raw[m_i] == '/') {
-                    m_i++;
-                    generateNodeEndXmlToken();
-                }
-                // start of node
-                else {
-                    generateNodeStartXmlToken();
-                }
+                const auto content = trim(m_raw.substr(start, m_i-start));
+                if (content.empty())
+                    continue;
 
+                token = { XmlTokenType::CONTENT, {}, content };
+                return true;
             }
-            else {
-                              
-                // content start
-                if (!isContent && m_raw[m_i] != '<') {                    
-                    if (m_raw[m_i] != ' ' && m_raw[m_i] != '\n' && m_raw[m_i] != '\r' && m_raw[m_i] != '\t') {
-                        isContent = true;
-                        contentStart = m_i;
-                    }
-                }
-              
-                m_i++;
 
+            m_i++;
+
+            // comment
+            if (m_raw.substr(m_i, 3) == "!--") {
+                m_i += 3;
+                lexComment(token);
             }
+            // declaration, skipped like a comment
+            else if (peek() == '!') {
+                m_i++;
+                token = { XmlTokenType::COMMENT, {}, until('>') };
+            }
+            // instruction
+            else if (peek() == '?') {
+                m_i++;
+                lexInstruction(token);
+            }
+            // end of node
+            else if (peek() == '/') {
+                m_i++;
+                token = { XmlTokenType::NODE_END, trim(until('>')), {} };
+            }
+            // start of node
+            else {
+                lexNodeStart(token);
+            }
+
+            return true;
         }
 
-        return m_tokens;
+        return false;
     }
 
 private:
-    void generateCommentXmlToken()
+    inline char peek() const { return m_i < m_raw.size() ? m_raw[m_i] : '\0'; }
+
+    static bool isSpace(const char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    static std::string_view trim(std::string_view str)
+    {
+        while (!str.empty() && isSpace(str.front()))
+            str.remove_prefix(1);
+        while (!str.empty() && isSpace(str.back()))
+            str.remove_suffix(1);
+        return str;
+    }
+
+    // returns everything up to the delimiter and moves behind it
+    std::string_view until(const std::string_view delim)
     {
         const size_t start = m_i;
-        while((m_raw[m_i] != '-' || m_raw[m_i+1] != '-' || m_raw[m_i+2] != '>') && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        const size_t end = m_i;
-        m_i += 3;
-
-        m_tokens.emplace_back(
-            XmlTokenType::COMMENT,
-            "",
-            m_raw.substr(start, end-start)
-        );
+        const size_t end = std::min(m_raw.find(delim, m_i), m_raw.size());
+        m_i = std::min(end + delim.size(), m_raw.size());
+        return m_raw.substr(start, end-start);
     }
 
-    void generateInstructionXmlToken()
+    std::string_view until(const char delim) { return until(std::string_view(&delim, 1)); }
+
+    void lexComment(XmlToken& token)
     {
-        // tag (target)
-        const size_t tagStart = m_i;
-        while((m_raw[m_i] != '?' || m_raw[m_i+1] != '>') && m_raw[m_i] != ' ' && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        const size_t tagEnd = m_i;
-        
-        m_tokens.emplace_back(
-            XmlTokenType::INSTRUCTION,
-            m_raw.substr(tagStart, tagEnd-tagStart),
-            ""
-        );
-    
-        // no content
-        if (m_raw[m_i] != ' ') {
-            m_i += 2;
-            return;
-        }
-        m_i++;
+        token = { XmlTokenType::COMMENT, {}, until("-->") };
+    }
 
-        // content
-        const size_t contentStart = m_i;              
-        while((m_raw[m_i] != '?' || m_raw[m_i+1] != '>') && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        const size_t contentEnd = m_i;
-        m_i += 2;
+    void lexInstruction(XmlToken& token)
+    {
+        const auto instruction = until("?>");
 
-        m_tokens.back().data = m_raw.substr(contentStart, contentEnd-contentStart);
+        size_t tagEnd = 0;
+        while (tagEnd < instruction.size() && !isSpace(instruction[tagEnd]))
+            tagEnd++;
+
+        token = { XmlTokenType::INSTRUCTION, instruction.substr(0, tagEnd), trim(instruction.substr(tagEnd)) };
     }
 
-    void generateNodeStartXmlToken()
+    void lexNodeStart(XmlToken& token)
     {
         // tag
         const size_t tagStart = m_i;
-        while(m_raw[m_i] != '>' &&  m_raw[m_i] != ' ' && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        size_t tagEnd = m_i;
-        m_i++;
-
-        m_tokens.emplace_back(
-            XmlTokenType::NODE_START,
-            m_raw.substr(tagStart, tagEnd-tagStart),
-            ""
-        );
-
-        if (m_raw[m_i-2] == '/') {
-            m_tokens.back().type = XmlTokenType::NODE_FULL;
-            tagEnd--;
-            m_tokens.back().tag = m_raw.substr(tagStart, tagEnd-tagStart);
+        while (m_i < m_raw.size() && !isSpace(m_raw[m_i]) && m_raw[m_i] != '>' && m_raw[m_i] != '/')
+            m_i++;
+        const auto tag = m_raw.substr(tagStart, m_i-tagStart);
+
+        // attributes, quoted values may contain '>'
+        const size_t dataStart = m_i;
+        char quote = '\0';
+        while (m_i < m_raw.size() && (quote != '\0' || m_raw[m_i] != '>')) {
+            if (quote == '\0' && (m_raw[m_i] == '"' || m_raw[m_i] == '\''))
+                quote = m_raw[m_i];
+            else if (m_raw[m_i] == quote)
+                quote = '\0';
+            m_i++;
         }
+        auto data = trim(m_raw.substr(dataStart, m_i-dataStart));
+        m_i = std::min(m_i + 1, m_raw.size());
 
-        // no content
-        if (m_raw[m_i-1] != ' ') {
-            if (m_raw[m_i-2] == '/')
-                m_tokens.back().type = XmlTokenType::NODE_FULL;
-            return;
+        XmlTokenType type = XmlTokenType::NODE_START;
+        if (!data.empty() && data.back() == '/') {
+            type = XmlTokenType::NODE_FULL;
+            data = trim(data.substr(0, data.size()-1));
         }
 
-        // content
-        const size_t contentStart = m_i;              
-        while(m_raw[m_i] != '>' && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        size_t contentEnd = m_i;
-        m_i++;
-
-        if (m_raw[m_i-2] == '/') {
-            m_tokens.back().type = XmlTokenType::NODE_FULL;
-            contentEnd--;
-        }
-        m_tokens.back().data = m_raw.substr(contentStart, contentEnd-contentStart);
+        token = { type, tag, data };
     }
 
-    void generateNodeEndXmlToken()
-    {
-        const size_t start = m_i;
-        while(m_raw[m_i] != '>' && m_i < m_raw.size()) { 
-            m_i++; 
-        }
-        const size_t end = m_i;
-        m_i++;
-
-        m_tokens.emplace_back(
-            XmlTokenType::NODE_END,
-            m_raw.substr(start, end-start),
-            ""
-        );
-    }
-
-    std::string m_raw;
+    std::string_view m_raw;
     size_t m_i;
-    std::vector<XmlToken> m_tokens;
 
-};
\ No newline at end of file
+};
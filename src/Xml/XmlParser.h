@@ -1,177 +1,69 @@
 #pragma once
 
 #include "Util/util.h"
-#include "XmlLexer.h"
+#include "XmlSaxParser.h"
+#include "XmlDocument.h"
 
-struct XmlNode
-{
-    XmlNode* parent;
-    std::vector<XmlNode> children;
-    std::string tag;
-    std::string content;
-    std::map<std::string, std::variant<int, float, std::string>> attributes;
-};
-
-class XmlParser
+// builds an XmlDocument from the sax events
+class XmlParser : private XmlSaxHandler
 {
 public:
-    XmlParser(const std::vector<XmlToken>& tokens) : m_tokens(tokens), m_i(0) {}
+    XmlParser(const std::string_view raw) : m_raw(raw), m_doc(nullptr) {}
 
-    XmlNode parse()
+    XmlDocument parse()
     {
-        m_root = XmlNode{
-            .parent = nullptr,
-            .children = {},
-            .tag = "",
-            .content = "",
-            .attributes = {}
-        };
-        m_i = 0;
-
-        if (m_tokens.empty())
-            return m_root;
-
-        createNodes(&m_root);
-        return m_root;
+        XmlDocument doc;
+        m_doc = &doc;
+
+        // rough guess from typical urdf density, avoids most regrowth
+        doc.m_nodes.reserve(m_raw.size() / 64 + 1);
+        doc.m_attributes.reserve(m_raw.size() / 32 + 1);
+        doc.m_nodes.push_back(XmlNode{ doc.intern(""), XmlDocument::s_none, XmlDocument::s_none, XmlDocument::s_none, 0, 0, {} });
+        m_stack = { { 0, XmlDocument::s_none } };
+
+        XmlSaxParser(m_raw).parse(*this);
+
+        m_doc = nullptr;
+        return doc;
     }
 
-    static void traverseNodes(const XmlNode& node, const std::function<void(const XmlNode&)>& func)
+private:
+    void startElement(const std::string_view tag) override
     {
-        for (auto child : node.children)
-            traverseNodes(child, func);
+        auto& [parent, lastChild] = m_stack.back();
+
+        const uint32_t node = static_cast<uint32_t>(m_doc->m_nodes.size());
+        m_doc->m_nodes.push_back(XmlNode{ m_doc->intern(tag), parent, XmlDocument::s_none, XmlDocument::s_none, static_cast<uint32_t>(m_doc->m_attributes.size()), 0, {} });
+
+        if (lastChild == XmlDocument::s_none)
+            m_doc->m_nodes[parent].firstChild = node;
+        else
+            m_doc->m_nodes[lastChild].nextSibling = node;
+        lastChild = node;
 
-        func(node);
+        m_stack.emplace_back(node, XmlDocument::s_none);
     }
 
-    static void print(const XmlNode& node, const int level = 0)
+    void attribute(const std::string_view name, const XmlValue& value) override
     {
-        if (level > 0) {
-            std::string ident(level-1, '\t');
-            std::cout << ident << "tag: " << node.tag;
-            if (!node.attributes.empty()) {
-                std::cout << ", attr:";
-                for (auto&[name, val] : node.attributes) {
-                    if (val.index() == 0)
-                        std::cout << " " << name << "=" << std::to_string(std::get<int>(val));
-                    else if (val.index() == 1)
-                        std::cout << " " << name << "=" << std::to_string(std::get<float>(val));
-                    else
-                        std::cout << " " << name << "=" << std::get<std::string>(val);
-                }
-            }
-            std::cout << ", content: " << node.content << '\n';
-        }
-
-        for (auto child : node.children)
-            print(child, level+1);
+        m_doc->m_attributes.push_back(XmlAttribute{ m_doc->intern(name), value });
+        m_doc->m_nodes[m_stack.back().first].numAttributes++;
     }
 
-private:
-    void createNodes(XmlNode* parent)
+    void endElement(const std::string_view /*tag*/) override
     {
-        while(m_i < m_tokens.size()) {
-            auto token = m_tokens[m_i++];
-            
-            // add content
-            if (token.type == XmlTokenType::CONTENT) {
-                parent->content = token.data;
-            }
-            // add full node
-            else if (token.type == XmlTokenType::NODE_FULL) {
-                parent->children.push_back(XmlNode{
-                    .parent = parent,
-                    .children = {},
-                    .tag = token.tag,
-                    .content = "",
-                    .attributes = {}
-                });
-                parseAttributes(parent->children.back(), token);
-            }
-            // start new node
-            else if (token.type == XmlTokenType::NODE_START) {
-                parent->children.push_back(XmlNode{
-                    .parent = parent,
-                    .children = {},
-                    .tag = token.tag,
-                    .content = "",
-                    .attributes = {}
-                });
-                parseAttributes(parent->children.back(), token);
-                createNodes(&parent->children.back());
-            }
-            // node end
-            else if (token.type == XmlTokenType::NODE_END) {
-                return;
-            }
-        }
+        m_stack.pop_back();
     }
 
-    void parseAttributes(XmlNode& node, const XmlToken& token)
+    void content(const std::string_view content) override
     {
-        const std::string attr = token.data;
-
-        bool isDigit = false;
-        bool isInt = false;
-        bool isVal = false;
-        bool valFirst = false;
-        bool quotExpectet = false;
-        std::string name, val;
-        for (const char c : attr) {
-            if (!isVal && c == ' ')
-                continue;
-
-            if (isVal) {
-                if (valFirst && c != ' ') {
-                    valFirst = false;
-                    quotExpectet = c == '"';
-                } 
-                else if (!valFirst) {
-                    if ((quotExpectet && c == '"') || (!quotExpectet && c == ' ')) {
-                        quotExpectet = false;
-                        isVal = false;
-                        if (!val.empty() && !name.empty()) {
-                            if (isDigit)
-                                try {
-                                    if (isInt)
-                                        node.attributes.emplace(name, std::stoi(val));
-                                    else 
-                                        node.attributes.emplace(name, std::stof(val));
-                                }
-                                catch(std::exception& e) {
-                                    node.attributes.emplace(name, val);
-                                }
-                            else
-                                node.attributes.emplace(name, val);
-                        }
-                        name = "";
-                    }
-                    else {
-                        if (c == ' ' || c == ',')
-                            isDigit = false;
-
-                        if (c == '.')
-                            isInt = false;
-
-                        val += c;
-                    }
-                }
-            } else {
-                if (c == '=') {
-                    isVal = true;
-                    valFirst = true;
-                    isInt = true;
-                    isDigit = true;
-                    val = "";
-                } 
-                else {
-                    name += c;
-                }
-            }
-        }
+        m_doc->m_nodes[m_stack.back().first].content = content;
     }
 
-    std::vector<XmlToken> m_tokens;
-    size_t m_i;
-    XmlNode m_root;
+    std::string_view m_raw;
+    XmlDocument* m_doc;
+
+    // open nodes with their last child, siblings are appended in O(1)
+    std::vector<std::pair<uint32_t, uint32_t>> m_stack;
 
-};
\ No newline at end of file
+};
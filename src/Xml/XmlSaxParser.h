@@ -0,0 +1,123 @@
+#pragma once
+
+#include "XmlLexer.h"
+
+#include "Util/util.h"
+
+class XmlSaxHandler
+{
+public:
+    virtual ~XmlSaxHandler() = default;
+
+    virtual void startElement(const std::string_view /*tag*/) {}
+    virtual void attribute(const std::string_view /*name*/, const XmlValue& /*value*/) {}
+    virtual void endElement(const std::string_view /*tag*/) {}
+    virtual void content(const std::string_view /*content*/) {}
+};
+
+// single pass over the source, memory only grows with the nesting depth
+class XmlSaxParser
+{
+public:
+    XmlSaxParser(const std::string_view raw) : m_raw(raw) {}
+
+    void parse(XmlSaxHandler& handler) const
+    {
+        std::vector<std::string_view> openTags;
+
+        XmlLexer lexer(m_raw);
+        XmlToken token;
+        while (lexer.next(token)) {
+
+            // content
+            if (token.type == XmlTokenType::CONTENT) {
+                handler.content(token.data);
+            }
+            // element, attributes follow the start event
+            else if (token.type == XmlTokenType::NODE_FULL || token.type == XmlTokenType::NODE_START) {
+                handler.startElement(token.tag);
+                parseAttributes(handler, token.data);
+
+                if (token.type == XmlTokenType::NODE_FULL)
+                    handler.endElement(token.tag);
+                else
+                    openTags.push_back(token.tag);
+            }
+            // element end
+            else if (token.type == XmlTokenType::NODE_END && !openTags.empty()) {
+                handler.endElement(openTags.back());
+                openTags.pop_back();
+            }
+        }
+    }
+
+private:
+    static bool isSpace(const char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    static void parseAttributes(XmlSaxHandler& handler, const std::string_view attr)
+    {
+        size_t i = 0;
+        const auto skipSpace = [&]() {
+            while (i < attr.size() && isSpace(attr[i]))
+                i++;
+        };
+
+        while (i < attr.size()) {
+            // name
+            skipSpace();
+            const size_t nameStart = i;
+            while (i < attr.size() && !isSpace(attr[i]) && attr[i] != '=')
+                i++;
+            const auto name = attr.substr(nameStart, i-nameStart);
+
+            skipSpace();
+            if (i >= attr.size() || attr[i] != '=')
+                continue;
+            i++;
+            skipSpace();
+
+            // value, quoted or up to the next space
+            std::string_view val;
+            if (i < attr.size() && (attr[i] == '"' || attr[i] == '\'')) {
+                const char quote = attr[i++];
+                const size_t valEnd = std::min(attr.find(quote, i), attr.size());
+                val = attr.substr(i, valEnd-i);
+                i = valEnd + 1;
+            }
+            else {
+                const size_t valStart = i;
+                while (i < attr.size() && !isSpace(attr[i]))
+                    i++;
+                val = attr.substr(valStart, i-valStart);
+            }
+
+            if (!name.empty() && !val.empty())
+                handler.attribute(name, parseValue(val));
+        }
+    }
+
+    static XmlValue parseValue(const std::string_view val)
+    {
+        const char* first = val.data();
+        const char* last = first + val.size();
+
+        // integers first, so "1" does not turn into a float
+        int i;
+        if (const auto [ptr, ec] = std::from_chars(first, last, i); ec == std::errc() && ptr == last)
+            return i;
+
+        // the list scan gives up after the fourth value, longer lists are left to the consumer
+        glm::vec3 v;
+        if (const auto n = parseFloats(val, std::span<float>(&v[0], 3)); n) {
+            if (*n == 1)
+                return v[0];
+            if (*n == 3)
+                return v;
+        }
+
+        return val;
+    }
+
+    std::string_view m_raw;
+
+};
@@ -31,13 +31,16 @@
 #include <ctime>
 #include <queue>
 #include <array>
+#include <atomic>
 #include <tuple>
 #include <mutex>
 #include <regex>
 #include <chrono>
 #include <memory>
+#include <random>
 #include <vector>
 #include <string>
+#include <cstring>
 #include <thread>
 #include <ranges>
 #include <numeric>
@@ -47,13 +50,18 @@
 #include <csignal>
 #include <sstream>
 #include <fstream>
+#include <future>
+#include <charconv>
 #include <optional>
+#include <span>
+#include <bit>
 #include <iostream>
 #include <algorithm>
 #include <functional>
 #include <filesystem>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <source_location>
 #include <condition_variable>
 